@@ -51,9 +51,18 @@
 #include <string>
 #include <cstring>
 #include <cstdio>
+#include <climits>
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <omp.h>
 
 namespace BioFVM{
 
+// longest variable name read_matlab_header() accepts (MATLAB's own 
+// names are at most 63 characters) 
+static const unsigned int max_matlab_name_length = 4096; 
+
 unsigned int thousands( unsigned int& input )
 { return input / 1000;}
 
@@ -66,401 +75,303 @@ unsigned int tens( unsigned int& input )
 unsigned int ones( unsigned int& input )
 { return (input % 10); }
 
-// vector< vector<double> > read_matlab4( string filename )
+// size (in bytes) of a single matrix entry for each of the 
+// MATLAB v4 data formats (P = 0, ..., 5). Returns 0 if unknown. 
 
-std::vector< std::vector<double> > read_matlab( std::string filename )
+size_t matlab_entry_size( unsigned int type_data_format )
 {
- // Matrix output;
- std::vector< std::vector<double> > output; 
- 
- FILE* fp; 
- fp = fopen( filename.c_str() , "rb" );
- if( fp == NULL )
+ switch( type_data_format )
  {
-  std::cout << "Error: could not open file " << filename << "!" << std::endl;
-  return output;
+  case 0: return sizeof(double); 
+  case 1: return sizeof(float); 
+  case 2: return sizeof(int); 
+  case 3: return sizeof(short); 
+  case 4: return sizeof(unsigned short); 
+  case 5: return sizeof(unsigned char); 
+  default: return 0; 
  }
- 
- typedef unsigned int UINT;
- UINT UINTs = sizeof(UINT);
- 
- // read the basic header information 
- 
- UINT temp;
- size_t result;
- result = fread( (char*) &temp , UINTs , 1 , fp );
- 
- UINT type_numeric_format = thousands(temp);
- UINT type_reserved = hundreds(temp);
- UINT type_data_format = tens(temp);
- UINT type_matrix_type = ones(temp);
-/*
-	cout << type_numeric_format << " " 
-		<< type_reserved << " " 
-		<< type_data_format << " " 
-		<< type_matrix_type << endl;
-*/
-	
- // make sure it's a matlab L4 file 
- 	  
- if( type_numeric_format != 0 || // 	little-endian
-     type_reserved != 0 || // should always be 0
-     type_data_format > 5 || // unknown format
-     type_matrix_type != 0 ) // want full matrices, not sparse 
- {
-  std::cout << "Error reading file " << filename << ": I can't read this format yet!" << std::endl;
-  return output;
- } 
-
- // get the size of the data 
- 
- UINT rows;
- result = fread( (char*) &rows , UINTs , 1, fp );
- 
- UINT cols;
- result = fread( (char*) &cols, UINTs , 1 , fp );
- 
- // resize the output accordingly 
+}
 
- // output.SetSize( rows, cols );
- 
+// all sizes and offsets are 64-bit, since rows*cols can exceed 2^32 
+// entries (e.g., 130M cells x 33 fields) and files can exceed 4 GB 
 
+bool seek_matlab_column( FILE* fp , off_t data_offset , unsigned int rows , unsigned int type_data_format , uint64_t column )
+{
+ off_t offset = data_offset + (off_t) ( column * (uint64_t) rows * (uint64_t) matlab_entry_size( type_data_format ) ); 
+ if( fseeko( fp , offset , SEEK_SET ) != 0 )
+ {
+  std::cout << "Error: could not seek to column " << column << "!" << std::endl;
+  return false; 
+ }
+ return true; 
+}
 
- std::vector<double> TemplateRow(cols,0.0);
- output.resize( rows , TemplateRow );
+// decode ncols whole columns (rows entries each) of the given format from 
+// buffer, and store them as output[i][j], i < rows, j0 <= j < j0+ncols. 
+// Different threads may decode disjoint column ranges into the same output. 
+// The output can be double or float (see explicit instantiations below). 
 
- // make sure we're not dealing with complex numbers 
- 
- UINT imag;
- result = fread( (char*) &imag, UINTs, 1 , fp );
- if( imag != 0 )
+template <class T> 
+void decode_matlab_columns( const char* buffer , unsigned int type_data_format , uint64_t rows , 
+	uint64_t j0 , uint64_t ncols , std::vector< std::vector<T> >& output )
+{
+ size_t n = 0; 
+ for( uint64_t j = j0; j < j0+ncols ; j++ )
  {
-  std::cout << "Error: I can't read imaginary matrices yet!" << std::endl;
-  return output;
+  for( uint64_t i = 0; i < rows ; i++ )
+  {
+   switch( type_data_format )
+   {
+    case 0: // all fields are doubles
+     (output[i])[j] = (T) ((const double*) buffer)[n]; break; 
+    case 1: // all fields are floats 
+     (output[i])[j] = (T) ((const float*) buffer)[n]; break; 
+    case 2: // all fields are signed ints of size 4 bytes  
+     (output[i])[j] = (T) ((const int*) buffer)[n]; break; 
+    case 3: // all fields are signed ints of size 2 bytes  
+     (output[i])[j] = (T) ((const short*) buffer)[n]; break; 
+    case 4: // all fields are unsigned ints of size 2 bytes  
+     (output[i])[j] = (T) ((const unsigned short*) buffer)[n]; break; 
+    case 5: // all fields are unsigned ints of size 1 bytes  
+     (output[i])[j] = (T) ((const unsigned char*) buffer)[n]; break; 
+   }
+   n++; 
+  }
  }
- 
- // Get the name of the variable. We don't tend to use this on reading (for now). 
- // But if we were to output a more complex data structure with 
- // vector< vector<double> > and vector<string>, we could! 
+ return; 
+}
 
- // if we actually use the names, then I'd suggest that we do a little parsing: 
- // is it a MultiCellDS field array? 
- // Make a format for that. Something like this:
- // MultiCellDS_Fields:name1,name2,...,nameN, where N = rows - 3; 
+// number of whole columns to read per block (about 1 MB) 
 
- UINT name_length;
- result = fread( (char*) &name_length, UINTs, 1 , fp );
- char* name;
- name = new char [name_length];
+uint64_t matlab_block_columns( uint64_t rows , size_t entry_size , uint64_t cols )
+{
+ uint64_t block_cols = 1; 
+ if( rows*entry_size > 0 )
+ { block_cols = (1<<20) / ( rows*entry_size ); }
+ if( block_cols < 1 )
+ { block_cols = 1; }
+ if( block_cols > cols )
+ { block_cols = cols; }
+ return block_cols; 
+}
 
- // this is the end of the 20-byte header 
+// Resizing each row in place (rather than replacing the rows) keeps their 
+// capacity, so a matrix reused for the next file of a run only grows when 
+// that file has more cells. Every entry is overwritten by the read. 
 
- // read the name
- 
- result = fread( name , name_length , 1 , fp );
+template <class T> 
+void resize_matlab_output( std::vector< std::vector<T> >& output , uint64_t rows , uint64_t cols )
+{
+ output.resize( rows ); 
+ for( uint64_t i=0; i < rows ; i++ )
+ { output[i].resize( cols ); }
+ return; 
+}
 
- // read the real part of the matrix
- unsigned int i = 0;
- unsigned int j = 0;
- 
- switch( type_data_format )
+// read cols x rows entries of the given format from fp (already positioned 
+// at the first entry), and store them as output[i][j], i < rows, j < cols. 
+// Data are read in blocks of whole columns rather than one entry at a time. 
+
+template <class T> 
+bool read_matlab_data( FILE* fp , unsigned int type_data_format , uint64_t rows, uint64_t cols , 
+	std::vector< std::vector<T> >& output )
+{
+ size_t entry_size = matlab_entry_size( type_data_format ); 
+ if( entry_size == 0 )
  {
-  case 0:
-   // all fields are doubles
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	double temp;
-	result = fread( (char*) &temp, sizeof(double), 1 , fp );
-	(output[i])[j] = temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }
-   break;
-   
-  case 1:
-   // all fields are floats 
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	float temp;
-	result = fread( (char*) &temp, sizeof(float), 1 , fp );
-	(output[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }
-   break;
-   
-  case 2:
-   // all fields are signed ints of size 4 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	int temp;
-	result = fread( (char*) &temp, sizeof(int), 1 , fp );
-	(output[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;
-   
-  case 3:
-   // all fields are signed ints of size 2 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	short temp;
-	result = fread( (char*) &temp, sizeof(short), 1 , fp );
-	(output[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;
-   
-  case 4:
-   // all fields are unsigned ints of size 2 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	unsigned short temp;
-	result = fread( (char*) &temp, sizeof(unsigned short), 1 , fp );
-	(output[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;  
-  
-  case 5:
-   // all fields are unsigned ints of size 1 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	unsigned char temp;
-	result = fread( (char*) &temp, sizeof(unsigned char), 1 , fp );
-	(output[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break; 
-   
-  default:
-   std::cout << "Error: Unknown format!" << std::endl;
-   break;
+  std::cout << "Error: Unknown format!" << std::endl;
+  return false; 
  }
+ if( rows == 0 || cols == 0 )
+ { return true; }
  
- // read the imaginary part of the matrix (not supported!)
+ uint64_t block_cols = matlab_block_columns( rows , entry_size , cols ); 
+ std::vector<char> buffer( block_cols*rows*entry_size ); 
  
- fclose( fp );
+ for( uint64_t j0 = 0; j0 < cols ; j0 += block_cols )
+ {
+  uint64_t ncols = block_cols; 
+  if( j0 + ncols > cols )
+  { ncols = cols - j0; }
+  
+  size_t count = (size_t) ( ncols*rows ); 
+  if( fread( buffer.data() , entry_size , count , fp ) != count )
+  {
+   std::cout << "Error: unexpected end of file at column " << j0 << "!" << std::endl;
+   return false; 
+  }
+  
+  decode_matlab_columns( buffer.data() , type_data_format , rows , j0 , ncols , output ); 
+ }
  
- delete name;
- return output;
+ return true; 
 }
 
-named_vector_data read_matlab_with_names( std::string filename )
+// Every column has a fixed size, so the byte range of any block of 
+// columns follows directly from the header. Each block (about 1 MB) is 
+// pread and decoded by its own task, into its own slice of the output. 
+
+template <class T> 
+static bool read_matlab_blocks( int fd , off_t data_offset , unsigned int type_data_format , 
+	uint64_t rows , uint64_t cols , std::vector< std::vector<T> >& output )
 {
- named_vector_data output; 
- 
- FILE* fp; 
- fp = fopen( filename.c_str() , "rb" );
- if( fp == NULL )
+ size_t entry_size = matlab_entry_size( type_data_format ); 
+ uint64_t column_size = rows * entry_size; 
+ uint64_t block_cols = matlab_block_columns( rows , entry_size , cols ); 
+ uint64_t blocks = ( cols + block_cols - 1 ) / block_cols; 
+ bool success = true; 
+ 
+ #pragma omp taskloop grainsize( 1 ) shared( success , output )
+ for( uint64_t b = 0 ; b < blocks ; b++ )
  {
-  std::cout << "Error: could not open file " << filename << "!" << std::endl;
-  return output;
+  uint64_t j0 = b*block_cols; 
+  uint64_t ncols = block_cols; 
+  if( j0 + ncols > cols )
+  { ncols = cols - j0; }
+  
+  std::vector<char> buffer( ncols*column_size ); 
+  
+  // pread may return fewer bytes than requested 
+  size_t size = (size_t) ( ncols*column_size ); 
+  size_t done = 0; 
+  while( done < size )
+  {
+   ssize_t result = pread( fd , buffer.data() + done , size - done , 
+	data_offset + (off_t) ( j0*column_size + done ) ); 
+   if( result <= 0 )
+   { break; }
+   done += result; 
+  }
+  if( done < size )
+  {
+   #pragma omp critical
+   { std::cout << "Error: unexpected end of file at column " << j0 << "!" << std::endl; }
+   #pragma omp atomic write
+   success = false; 
+  }
+  else
+  { decode_matlab_columns( buffer.data() , type_data_format , rows , j0 , ncols , output ); }
  }
  
- typedef unsigned int UINT;
- UINT UINTs = sizeof(UINT);
- 
- // read the basic header information 
+ return success; 
+}
+
+template <class T> 
+bool read_matlab_parallel( std::string filename , int number_of_threads , std::vector< std::vector<T> >& output )
+{
+ unsigned int rows; 
+ unsigned int cols; 
+ unsigned int type_data_format; 
+ off_t data_offset; 
  
- UINT temp;
- size_t result;
- result = fread( (char*) &temp , UINTs , 1 , fp );
+ FILE* fp = read_matlab_header( &rows, &cols, &type_data_format, &data_offset, NULL, filename ); 
+ if( fp == NULL )
+ { return false; }
  
- UINT type_numeric_format = thousands(temp);
- UINT type_reserved = hundreds(temp);
- UINT type_data_format = tens(temp);
- UINT type_matrix_type = ones(temp);
-	
- // make sure it's a matlab L4 file 
- 	  
- if( type_numeric_format != 0 || // 	little-endian
-     type_reserved != 0 || // should always be 0
-     type_data_format > 5 || // unknown format
-     type_matrix_type != 0 ) // want full matrices, not sparse 
+ size_t entry_size = matlab_entry_size( type_data_format ); 
+ uint64_t column_size = (uint64_t) rows * entry_size; 
+ fseeko( fp , 0 , SEEK_END ); 
+ off_t file_size = ftello( fp ); 
+ if( file_size < data_offset + (off_t) ( column_size * cols ) )
  {
-  std::cout << "Error reading file " << filename << ": I can't read this format yet!" << std::endl;
-  return output;
- } 
-
- // get the size of the data 
+  std::cout << "Error reading file " << filename << ": expected " << data_offset + (off_t) ( column_size * cols ) 
+            << " bytes but found " << file_size << "!" << std::endl;
+  fclose( fp ); 
+  return false; 
+ }
  
- UINT rows;
- result = fread( (char*) &rows , UINTs , 1, fp );
+ resize_matlab_output( output , rows , cols ); 
+ if( rows == 0 || cols == 0 )
+ {
+  fclose( fp ); 
+  return true; 
+ }
  
- UINT cols;
- result = fread( (char*) &cols, UINTs , 1 , fp );
+ if( number_of_threads < 1 )
+ { number_of_threads = 1; }
  
- // resize the output accordingly 
-
- std::vector<double> TemplateRow(cols,0.0);
-
- output.data.resize( rows , TemplateRow );
-
- // make sure we're not dealing with complex numbers 
+ // Inside a parallel region (e.g., from a frame task), the block tasks 
+ // join that team's tasks, so any idle thread of the team can take them. 
+ // Otherwise, start a team of number_of_threads to run them. 
  
- UINT imag;
- result = fread( (char*) &imag, UINTs, 1 , fp );
- if( imag != 0 )
+ int fd = fileno( fp ); 
+ bool success = true; 
+ if( omp_in_parallel() )
+ { success = read_matlab_blocks( fd , data_offset , type_data_format , rows , cols , output ); }
+ else
  {
-  std::cout << "Error: I can't read imaginary matrices yet!" << std::endl;
-  return output;
+  #pragma omp parallel num_threads( number_of_threads )
+  #pragma omp single
+  success = read_matlab_blocks( fd , data_offset , type_data_format , rows , cols , output ); 
  }
  
- // Get the name of the variable. We don't tend to use this on reading (for now). 
- // But if we were to output a more complex data structure with 
- // vector< vector<double> > and vector<string>, we could! 
+ fclose( fp ); 
+ if( success == false )
+ { output.clear(); }
+ return success; 
+}
 
- // if we actually use the names, then I'd suggest that we do a little parsing: 
- // is it a MultiCellDS field array? 
- // Make a format for that. Something like this:
- // MultiCellDS_Fields:name1,name2,...,nameN, where N = rows - 3; 
+// vector< vector<double> > read_matlab4( string filename )
 
- UINT name_length;
- result = fread( (char*) &name_length, UINTs, 1 , fp );
- char* name;
- name = new char [name_length];
+std::vector< std::vector<double> > read_matlab( std::string filename )
+{
+ std::vector< std::vector<double> > output; 
+ read_matlab( filename , output , NULL ); 
+ return output; 
+}
 
- // this is the end of the 20-byte header 
+named_vector_data read_matlab_with_names( std::string filename )
+{
+ named_vector_data output; 
+ std::string name; 
+ read_matlab( filename , output.data , &name ); 
+ output.names.push_back( name ); 
+ return output; 
+}
 
- // read the name
+template <class T> 
+bool read_matlab( std::string filename , std::vector< std::vector<T> >& output , std::string* variable_name )
+{
+ unsigned int rows; 
+ unsigned int cols; 
+ unsigned int type_data_format; 
+ off_t data_offset; 
  
- result = fread( name , name_length , 1 , fp );
- output.names[0] = name; 
-
- // read the real part of the matrix
- unsigned int i = 0;
- unsigned int j = 0;
+ FILE* fp = read_matlab_header( &rows, &cols, &type_data_format, &data_offset, variable_name, filename ); 
+ if( fp == NULL )
+ { return false; }
  
- switch( type_data_format )
+ // make sure the file actually holds rows*cols entries (catches truncated 
+ // or still-being-written files before we allocate anything) 
+ 
+ uint64_t data_size = (uint64_t) rows * (uint64_t) cols * (uint64_t) matlab_entry_size( type_data_format ); 
+ fseeko( fp , 0 , SEEK_END ); 
+ off_t file_size = ftello( fp ); 
+ if( file_size < data_offset + (off_t) data_size )
  {
-  case 0:
-   // all fields are doubles
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	double temp;
-	result = fread( (char*) &temp, sizeof(double), 1 , fp );
-	(output.data[i])[j] = temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }
-   break;
-   
-  case 1:
-   // all fields are floats 
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	float temp;
-	result = fread( (char*) &temp, sizeof(float), 1 , fp );
-	(output.data[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }
-   break;
-   
-  case 2:
-   // all fields are signed ints of size 4 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	int temp;
-	result = fread( (char*) &temp, sizeof(int), 1 , fp );
-	(output.data[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;
-   
-  case 3:
-   // all fields are signed ints of size 2 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	short temp;
-	result = fread( (char*) &temp, sizeof(short), 1 , fp );
-	(output.data[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;
-   
-  case 4:
-   // all fields are unsigned ints of size 2 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	unsigned short temp;
-	result = fread( (char*) &temp, sizeof(unsigned short), 1 , fp );
-	(output.data[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break;  
-  
-  case 5:
-   // all fields are unsigned ints of size 1 bytes  
-   
-   for( unsigned int n=0; n < rows*cols ; n++ )
-   {
-	unsigned char temp;
-	result = fread( (char*) &temp, sizeof(unsigned char), 1 , fp );
-	(output.data[i])[j] = (double) temp; 
-    i++;
-	
-	if( i == rows )
-    { i=0; j++; }
-   }  
-   break; 
-   
-  default:
-   std::cout << "Error: Unknown format!" << std::endl;
-   break;
+  std::cout << "Error reading file " << filename << ": expected " << data_offset + (off_t) data_size 
+            << " bytes but found " << file_size << "!" << std::endl;
+  fclose( fp ); 
+  return false; 
  }
+ seek_matlab_column( fp , data_offset , rows , type_data_format , 0 ); 
  
+ // resize the output accordingly 
+
+ resize_matlab_output( output , rows , cols ); 
+
+ // read the real part of the matrix
+ 
+ bool success = read_matlab_data( fp , type_data_format , rows , cols , output ); 
  
  // read the imaginary part of the matrix (not supported!)
  
  fclose( fp );
- 
- delete name;
- return output;
+ return success;
 }
 
-FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , std::string filename )
+FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , unsigned int* type_data_format , 
+	off_t* data_offset, std::string* variable_name, std::string filename )
 {
  FILE* fp; 
  fp = fopen( filename.c_str() , "rb" );
@@ -475,21 +386,22 @@ FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , std::string f
  
  // read the basic header information 
  
- UINT temp;
+ UINT temp = 0;
  
  size_t result;
  result = fread( (char*) &temp , UINTs , 1 , fp );
  
  UINT type_numeric_format = thousands(temp);
  UINT type_reserved = hundreds(temp);
- UINT type_data_format = tens(temp);
+ *type_data_format = tens(temp);
  UINT type_matrix_type = ones(temp);
 	
  // make sure it's a matlab L4 file 
  	  
- if( type_numeric_format != 0 || // 	little-endian
+ if( result != 1 || 
+     type_numeric_format != 0 || // 	little-endian
      type_reserved != 0 || // should always be 0
-     type_data_format > 5 || // unknown format
+     *type_data_format > 5 || // unknown format
      type_matrix_type != 0 ) // want full matrices, not sparse 
  {
   std::cout << "Error reading file " << filename << ": I can't read this format yet!" << std::endl;
@@ -497,20 +409,23 @@ FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , std::string f
   return NULL;
  } 
 
- // get the size of the data 
- 
-// UINT rows;
- result = fread( (char*) rows , UINTs , 1, fp );
+ // get the size of the data, whether it is complex, and the length of 
+ // the variable name (the rest of the 20-byte header) 
  
-// UINT cols;
-result =  fread( (char*) cols, UINTs , 1 , fp );
+ UINT imag = 0;
+ UINT name_length = 0;
+ if( fread( (char*) rows , UINTs , 1, fp ) != 1 || 
+     fread( (char*) cols, UINTs , 1 , fp ) != 1 || 
+     fread( (char*) &imag, UINTs, 1 , fp ) != 1 || 
+     fread( (char*) &name_length, UINTs, 1 , fp ) != 1 )
+ {
+  std::cout << "Error reading file " << filename << ": incomplete header!" << std::endl;
+  fclose( fp );
+  return NULL;
+ }
  
- // resize the output accordingly 
-
  // make sure we're not dealing with complex numbers 
  
- UINT imag;
- result = fread( (char*) &imag, UINTs, 1 , fp );
  if( imag != 0 )
  {
   std::cout << "Error: I can't read imaginary matrices yet!" << std::endl;
@@ -518,23 +433,62 @@ result =  fread( (char*) cols, UINTs , 1 , fp );
   return NULL;
  }
 
- UINT name_length;
- result = fread( (char*) &name_length, UINTs, 1 , fp );
- char* name;
- name = new char [name_length];
+ // Get the name of the variable. We don't tend to use this on reading (for now). 
+ // But if we were to output a more complex data structure with 
+ // vector< vector<double> > and vector<string>, we could! 
 
- // this is the end of the 20-byte header 
+ // if we actually use the names, then I'd suggest that we do a little parsing: 
+ // is it a MultiCellDS field array? 
+ // Make a format for that. Something like this:
+ // MultiCellDS_Fields:name1,name2,...,nameN, where N = rows - 3; 
 
- // read the name
+ // read the name (the stored length includes the terminating null); a 
+ // corrupt length is rejected before allocating for it 
+ 
+ struct stat info; 
+ if( name_length > max_matlab_name_length || fstat( fileno( fp ) , &info ) != 0 || 
+     (off_t) name_length > info.st_size - ftello( fp ) )
+ {
+  std::cout << "Error reading file " << filename << ": bad variable name length " << name_length << "!" << std::endl;
+  fclose( fp );
+  return NULL;
+ }
+ 
+ std::vector<char> name( name_length + 1 , '\0' ); 
+ if( fread( name.data() , 1 , name_length , fp ) != name_length )
+ {
+  std::cout << "Error reading file " << filename << ": incomplete header!" << std::endl;
+  fclose( fp );
+  return NULL;
+ }
+ if( variable_name != NULL )
+ { *variable_name = name.data(); }
+ 
+ *data_offset = ftello( fp ); 
  
- result = fread( name , name_length , 1 , fp );
- delete name; 
-  
  return fp; 
 }
 
-FILE* write_matlab4_header( int nrows, int ncols, std::string filename, std::string variable_name )
+FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , std::string filename )
+{
+ unsigned int type_data_format; 
+ off_t data_offset; 
+ return read_matlab_header( rows, cols, &type_data_format, &data_offset, NULL, filename ); 
+}
+
+FILE* write_matlab4_header( uint64_t nrows, uint64_t ncols, std::string filename, std::string variable_name )
 {
+ typedef unsigned int UINT;
+ UINT UINTs = sizeof(UINT);
+
+ // the v4 header stores rows and cols as 32-bit integers 
+ 
+ if( nrows > UINT_MAX || ncols > UINT_MAX )
+ {
+  std::cout << "Error: " << nrows << " x " << ncols << " is too large for a MATLAB v4 file!" << std::endl;
+  return NULL;
+ }
+ 
  FILE* fp; 
  fp = fopen( filename.c_str() , "wb" );
  if( fp == NULL )
@@ -543,9 +497,6 @@ FILE* write_matlab4_header( int nrows, int ncols, std::string filename, std::str
   return NULL;
  }
  
- typedef unsigned int UINT;
- UINT UINTs = sizeof(UINT);
- 
  UINT temp;
  
  UINT type_numeric_format = 0; // little-endian assumed for now!
@@ -584,31 +535,29 @@ FILE* write_matlab_header( unsigned int rows, unsigned int cols, std::string fil
  return write_matlab4_header( rows, cols, filename, variable_name );  
 }
 
-bool write_matlab4( std::vector< std::vector<double> > input, std::string filename , std::string variable_name )
+bool write_matlab4( const std::vector< std::vector<double> >& input, std::string filename , std::string variable_name )
 {
- int number_of_data_entries = input.size();
- int size_of_each_datum = input[0].size();
+ if( input.size() == 0 )
+ { return false; }
  
- int rows = size_of_each_datum; // storing data as cols
- int cols = number_of_data_entries; // storing data as cols
+ uint64_t number_of_data_entries = input.size();
+ uint64_t size_of_each_datum = input[0].size();
+ 
+ uint64_t rows = size_of_each_datum; // storing data as cols
+ uint64_t cols = number_of_data_entries; // storing data as cols
  
  FILE* fp = write_matlab4_header( rows, cols ,  filename, variable_name ); 
+ if( fp == NULL )
+ { return false; }
 
- // // storing data as rows 
- // for( int j=0; j < size_of_each_datum ; j++ )
- // { 
-  // for( int i=0; i < number_of_data_entries ; i++ )
-  // {
-   // fwrite( (char*) &(input[i])[j] , sizeof(double), 1 , fp );
-  // }
- // }
-
- // storing data as cols 
- for( int i=0; i < number_of_data_entries ; i++ )
+ // storing data as cols: each input[i] is one contiguous column 
+ for( uint64_t i=0; i < number_of_data_entries ; i++ )
  {
-  for( int j=0; j < size_of_each_datum ; j++ )
+  if( fwrite( (char*) input[i].data() , sizeof(double), size_of_each_datum , fp ) != size_of_each_datum )
   {
-   fwrite( (char*) &(input[i])[j] , sizeof(double), 1 , fp );
+   std::cout << "Error: could not write column " << i << " to " << filename << "!" << std::endl;
+   fclose( fp );
+   return false; 
   }
  }
  
@@ -621,4 +570,17 @@ bool write_matlab( std::vector< std::vector<double> >& input , std::string filen
  return write_matlab4( input, filename , "none" );
 }
 
+// the readers can decode into double or single precision 
+
+template void resize_matlab_output( std::vector< std::vector<double> >& , uint64_t , uint64_t ); 
+template void resize_matlab_output( std::vector< std::vector<float> >& , uint64_t , uint64_t ); 
+template bool read_matlab( std::string , std::vector< std::vector<double> >& , std::string* ); 
+template bool read_matlab( std::string , std::vector< std::vector<float> >& , std::string* ); 
+template bool read_matlab_parallel( std::string , int , std::vector< std::vector<double> >& ); 
+template bool read_matlab_parallel( std::string , int , std::vector< std::vector<float> >& ); 
+template bool read_matlab_data( FILE* , unsigned int , uint64_t , uint64_t , std::vector< std::vector<double> >& ); 
+template bool read_matlab_data( FILE* , unsigned int , uint64_t , uint64_t , std::vector< std::vector<float> >& ); 
+template void decode_matlab_columns( const char* , unsigned int , uint64_t , uint64_t , uint64_t , std::vector< std::vector<double> >& ); 
+template void decode_matlab_columns( const char* , unsigned int , uint64_t , uint64_t , uint64_t , std::vector< std::vector<float> >& ); 
+
 };
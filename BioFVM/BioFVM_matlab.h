@@ -51,6 +51,8 @@
 #include <cstring>
 #include <vector>
 #include <iostream>
+#include <cstdint>
+#include <sys/types.h>
 
 #include <ctime>
 #include <string>
@@ -89,6 +91,43 @@ FILE* write_matlab_header( unsigned int rows, unsigned int cols, std::string fil
 // output: FILE pointer, and overwrites rows, cols so you know the size 
 FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , std::string filename ); 
 
+// as above, but also returns the data format (P), the byte offset of the first 
+// matrix entry, and (if variable_name is not NULL) the variable name 
+FILE* read_matlab_header( unsigned int* rows, unsigned int* cols , unsigned int* type_data_format , 
+	off_t* data_offset, std::string* variable_name, std::string filename ); 
+
+// decode the type field of the header (MOPT) 
+unsigned int thousands( unsigned int& input ); 
+unsigned int hundreds( unsigned int& input ); 
+unsigned int tens( unsigned int& input ); 
+unsigned int ones( unsigned int& input ); 
+
+// rows*cols can exceed 2^32 entries, and files can exceed 4 GB, 
+// so all sizes and offsets past the header are 64-bit 
+size_t matlab_entry_size( unsigned int type_data_format ); 
+bool seek_matlab_column( FILE* fp , off_t data_offset , unsigned int rows , unsigned int type_data_format , uint64_t column ); 
+
+// These decode into double or float (T), so callers can keep the 
+// data in single precision. They return false on failure. 
+
+template <class T> 
+bool read_matlab( std::string filename , std::vector< std::vector<T> >& output , std::string* variable_name ); 
+// rows x cols, reusing the existing rows' memory (e.g., from the last frame) 
+template <class T> 
+void resize_matlab_output( std::vector< std::vector<T> >& output , uint64_t rows , uint64_t cols ); 
+template <class T> 
+bool read_matlab_data( FILE* fp , unsigned int type_data_format , uint64_t rows, uint64_t cols , 
+	std::vector< std::vector<T> >& output ); 
+template <class T> 
+void decode_matlab_columns( const char* buffer , unsigned int type_data_format , uint64_t rows , 
+	uint64_t j0 , uint64_t ncols , std::vector< std::vector<T> >& output ); 
+
+// read a single (large) file as OpenMP tasks, each pread-ing and decoding 
+// a block of columns: in the current team if called in a parallel region, 
+// else in a new team of number_of_threads 
+template <class T> 
+bool read_matlab_parallel( std::string filename , int number_of_threads , std::vector< std::vector<T> >& output ); 
+
 };
 
 #endif 
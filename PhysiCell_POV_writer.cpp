@@ -71,6 +71,7 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <algorithm>
 
 #include <omp.h> 
 
@@ -80,77 +81,422 @@
 #include "./BioFVM/BioFVM_vector.h" 
 
 #include "./custom_modules/povwriter.h" 
+#include "./custom_modules/povwriter_archive.h" 
+#include "./custom_modules/povwriter_prefetch.h" 
+#include "./custom_modules/povwriter_tar.h" 
+#include "./custom_modules/povwriter_pipeline.h" 
+#include "./custom_modules/povwriter_admission.h" 
+#include "./custom_modules/povwriter_topology.h" 
+#include "./custom_modules/povwriter_numa.h" 
+#include "./custom_modules/povwriter_arena.h" 
+#include "./custom_modules/povwriter_buffers.h" 
+#include "./custom_modules/povwriter_manifest.h" 
+#include "./custom_modules/povwriter_journal.h" 
+#include "./custom_modules/povwriter_watch.h" 
+#include "./custom_modules/povwriter_server.h" 
+#include "./custom_modules/povwriter_shm.h" 
+#include "./custom_modules/povwriter_render.h" 
+#include "./custom_modules/povwriter_tiles.h" 
+#include "./custom_modules/povwriter_views.h" 
 
-int main( int argc, char* argv[] )
+// read, render, and write the frame at position n of the schedule 
+
+void process_frame( std::vector<int>& file_indices , unsigned int n , int decode_threads )
 {
-	display_splash( std::cout ); 
+	// all of the frame's allocations come from (and go back to) this 
+	// thread's frame arena, if enabled 
+	Frame_Arena_Scope arena_scope; 
+	Page_Fault_Counter page_faults; 
+	uint64_t source_hash = frame_manifest.is_open() ? frame_source_hash( file_indices[n] ) : 0; 
+	
+	// Otherwise, reuse this thread's cell data and output buffers from its 
+	// last frame. (With a memory budget, they are released after each 
+	// frame, so that the budget holds.) 
+	Frame_Buffers frame_buffers; 
+	Frame_Buffers& buffers = options.frame_arena ? frame_buffers : thread_frame_buffers(); 
+	std::vector< std::vector<cell_real> >& MAT = buffers.MAT; 
+	
+	uint64_t frame_memory = 0; 
+	if( memory_admission.enabled() )
+	{
+		frame_memory = estimate_frame_memory( file_indices[n] ); 
+		memory_admission.admit( frame_memory ); 
+	}
+	render_jobs.scene_started(); 
 	
+	frame_prefetcher.frame_started( n ); 
+	double start_time = omp_get_wtime(); 
+
+	// read the matrix 
+	// std::vector< std::vector<double> > MAT = read_matlab( options.filename.c_str() );
+	std::string filename = create_filename( file_indices[n] ); 
+	std::cout << "Processing file " << filename << "... " << std::endl; 
+
+	if( read_cell_data( file_indices[n] , MAT , decode_threads ) == false )
+	{
+		std::cout << "Skipping " << filename << " ... " << std::endl << std::endl; 
+		memory_admission.release( frame_memory ); 
+		Heap_Allocation_Scope heap; 
+		std::vector<std::string> no_scenes; 
+		render_jobs.scene_finished( file_indices[n] , no_scenes , omp_get_wtime() - start_time ); 
+		return; 
+	}
+	std::cout << "Matrix size: " << MAT.size() << " x " << MAT[0].size() << std::endl; 
+	double read_time = omp_get_wtime(); 
+
+	// start output 
+	filename = create_output_filename( file_indices[n] ); 
+
+	std::cout << "Creating file " << filename << " for output ... " << std::endl; 
+
+	// now, place the cells	
+	std::cout << "Writing " << MAT[0].size() << " cells ... " <<std::endl; 
+
+	// the whole scene, or one scene per camera (sharing the cells), or one 
+	// culled scene per tile 
+	std::vector<std::string> scenes; 
+	std::string include = ""; 
+	bool written; 
+	if( options.cameras.size() > 1 )
+	{ written = write_frame_views( file_indices[n] , MAT , buffers.output , scenes , include ); }
+	else if( options.tiles )
+	{ written = write_frame_tiles( file_indices[n] , MAT , buffers.output , scenes ); }
+	else
+	{
+		buffers.output.open( filename ); 
+		std::ostream os( &buffers.output ); 
+		write_frame( os , MAT ); 
+		written = buffers.output.close(); 
+		if( written )
+		{
+			scenes.push_back( filename ); 
+			Heap_Allocation_Scope heap; 
+			frame_manifest.record( file_indices[n] , source_hash , buffers.output.size() ); 
+		}
+		else
+		{ std::cout << "Error: could not write " << filename << "!" << std::endl; }
+	}
+	// a rendered frame is journaled once its renders are done (the 
+	// journal's entries and the render jobs outlive the frame's arena) 
+	if( written && render_jobs.enabled() == false )
+	{
+		Heap_Allocation_Scope heap; 
+		frame_journal.record( file_indices[n] ); 
+	}
+	if( memory_admission.enabled() )
+	{ buffers.release(); }
+	memory_admission.release( frame_memory ); 
+	
+	// hand the scenes to the render command (and the core to a render) 
+	if( written == false )
+	{ scenes.clear(); }
+	{
+		Heap_Allocation_Scope heap; 
+		std::vector<std::string> shared; 
+		if( include.size() > 0 )
+		{ shared.push_back( include ); }
+		render_jobs.scene_finished( file_indices[n] , scenes , omp_get_wtime() - start_time , shared ); 
+	}
+
+	frame_prefetcher.frame_finished( n , read_time - start_time , omp_get_wtime() - read_time ); 
+	std::cout << "done! (" << page_faults.minor() << " minor, " << page_faults.major() << " major page faults)" << std::endl << std::endl ; 
+	page_faults.record(); 
+	return; 
+}
+
+int main( int argc, char* argv[] )
+{
 	std::string config_file = "./config/povwriter-settings.xml"; 
 	
 	std::vector<int> file_indices; 
+	std::string pack_archive = ""; 
+	bool resume = false; 
+	bool watch = false; 
+	std::string serve_socket = ""; 
+	std::string shared_memory = ""; 
+	std::string output = ""; 
 	
 	// process command-line arguments 
 	bool XML_status = false; 
-	if( argc > 1 )
+	for( int k=1; k < argc ; k++ )
 	{
-		if( is_xml(argv[1]) )
+		if( strcmp( argv[k] , "--pack" ) == 0 && k+1 < argc )
+		{
+			pack_archive = argv[++k]; 
+		}
+		else if( strcmp( argv[k] , "--resume" ) == 0 )
+		{
+			resume = true; 
+		}
+		else if( strcmp( argv[k] , "--serve" ) == 0 && k+1 < argc )
+		{
+			serve_socket = argv[++k]; 
+		}
+		else if( strcmp( argv[k] , "--shm" ) == 0 && k+1 < argc )
+		{
+			shared_memory = argv[++k]; 
+		}
+		else if( strcmp( argv[k] , "-o" ) == 0 && k+1 < argc )
+		{
+			output = argv[++k]; 
+		}
+		else if( strcmp( argv[k] , "--watch" ) == 0 )
 		{
-			config_file = argv[1]; 
+			watch = true; 
+		}
+		else if( is_xml(argv[k]) )
+		{
+			config_file = argv[k]; 
 		}
 		else
 		{
-			file_indices = create_index_list( argv[1] ); 
+			file_indices = create_index_list( argv[k] ); 
 		}
 	}
 	
+	// with the scenes on stdout, everything else goes to stderr 
+	if( output == "-" )
+	{ std::cout.rdbuf( std::cerr.rdbuf() ); }
+	display_splash( std::cout ); 
+	
 	XML_status = load_config_file( config_file ); 
 	if( !XML_status )
 	{ exit(-1); }
+	if( output.size() > 0 )
+	{ options.output = output; }
+	
+	// a stream (stdout or a named pipe) gets every frame, in order 
+	bool stream_output = is_stream_output( options.output ); 
+	if( stream_output )
+	{
+		options.incremental = false; 
+		options.journal = ""; 
+		options.render = false; 
+		options.tiles = false; 
+		options.cameras.resize( std::min( (int) options.cameras.size() , 1 ) ); 
+	}
+	
+	// rendered, multi-camera, and tiled frames are built as frame tasks 
+	// (whose cores the renders share); the manifest tracks whole scenes 
+	// only. Camera views are not tiled. 
+	bool multiple_cameras = options.cameras.size() > 1; 
+	if( multiple_cameras )
+	{ options.tiles = false; }
+	if( options.render || options.tiles || multiple_cameras )
+	{ options.pipeline = false; }
+	if( options.tiles || multiple_cameras )
+	{ options.incremental = false; }
 
-	if( file_indices.size() == 0 )
+	if( file_indices.size() == 0 && watch == false )
 	{
 		file_indices.push_back( options.time_index ); 
 	}
 	
+	// a file pattern needs one index field (e.g., pov%08i.pov), unless it 
+	// names a single frame's file 
+	if( stream_output == false )
+	{
+		int fields = output_index_fields( options.output ); 
+		if( fields < 0 || fields > 1 )
+		{
+			std::cout << "Error: output " << options.output << " may only have one %d or %i field (e.g., pov%08i.pov)!" << std::endl; 
+			exit(-1); 
+		}
+		if( fields == 0 && ( file_indices.size() > 1 || watch || serve_socket.size() > 0 || shared_memory.size() > 0 ) )
+		{
+			std::cout << "Error: output " << options.output << " has no %d or %i field for the frame index," 
+				<< " so every frame would overwrite the last!" << std::endl; 
+			exit(-1); 
+		}
+	}
+	
+	// pack the snapshots into a single archive, rather than render them 
+	
+	if( pack_archive.size() > 0 )
+	{
+		if( write_snapshot_archive( pack_archive , file_indices , options.archive_keyframe_interval ) == false )
+		{ exit(-1); }
+		return 0; 
+	}
+	
+	if( options.archive.size() > 0 && snapshot_archive.open( options.archive ) == false )
+	{ exit(-1); }
+	if( options.tar.size() > 0 && tar_archive.open( options.tar ) == false )
+	{ exit(-1); }
+	
 	// set options 
 	
-	default_POV_options.set_camera_from_spherical_location( options.camera_distance , options.camera_theta, options.camera_phi ); //  1500, 5*pi/4.0 , pi/3.0 ); // do
-	default_POV_options.light_position[0] *= 0.5; 
+	setup_POV_camera(); 
+	
+	// answer render requests on a socket, or render the frames that a 
+	// simulation publishes to shared memory, rather than render a batch 
+	
+	if( serve_socket.size() > 0 || shared_memory.size() > 0 )
+	{
+		omp_set_num_threads(options.threads);
+		if( options.pin_threads )
+		{ pin_openmp_threads( options.threads , std::cout ); }
+		bool served = serve_socket.size() > 0 ? run_render_server( serve_socket , std::cout ) 
+			: run_shared_memory_consumer( shared_memory , std::cout ); 
+		if( served == false )
+		{ exit(-1); }
+		return 0; 
+	}
+	
+	// only render the frames whose source or settings changed since 
+	// their last render 
+	
+	if( options.incremental )
+	{
+		if( frame_manifest.open( options.manifest ) == false )
+		{ exit(-1); }
+		unsigned int requested = file_indices.size(); 
+		file_indices = stale_frames( file_indices ); 
+		std::cout << "Skipping " << requested - file_indices.size() << " of " << requested 
+			<< " frames that are up to date in " << options.manifest << " ... " << std::endl; 
+	}
+	
+	// journal the finished frames; after a crash, --resume skips them 
+	
+	if( options.journal.size() > 0 )
+	{
+		if( frame_journal.open( options.journal , resume ) == false )
+		{ exit(-1); }
+		if( resume )
+		{
+			std::vector<int> remaining; 
+			for( int n=0 ; n < file_indices.size() ; n++ )
+			{
+				if( frame_journal.is_done( file_indices[n] ) == false )
+				{ remaining.push_back( file_indices[n] ); }
+			}
+			std::cout << "Resuming: skipping " << file_indices.size() - remaining.size() << " of " << file_indices.size() 
+				<< " frames finished in " << options.journal << " ... " << std::endl; 
+			file_indices = remaining; 
+		}
+	}
 
 	// process all the files 
 	
+	// (the NUMA scheduler pins its own threads, when it runs) 
+	
 	omp_set_num_threads(options.threads);
-	#pragma omp parallel for 
-	for( int n =0 ; n < file_indices.size() ; n++ )
-	{	
-		// read the matrix 
-		// std::vector< std::vector<double> > MAT = read_matlab( options.filename.c_str() );
-		std::string filename = create_filename( file_indices[n] ); 
-		std::cout << "Processing file " << filename << "... " << std::endl; 
-
-		std::vector< std::vector<double> > MAT = read_matlab( filename );
-		std::cout << "Matrix size: " << MAT.size() << " x " << MAT[0].size() << std::endl; 
-		
-		// start output 
-		char temp [1024]; 
-		// sprintf( temp , "pov%08i.pov" , options.time_index ); 
-		sprintf( temp , "pov%08i.pov" , file_indices[n] ); 
-		filename = temp ; 
-		std::ofstream os( filename.c_str() , std::ios::out ); 
-		
-		std::cout << "Creating file " << filename << " for output ... " << std::endl; 
-		Write_POV_start( os ); 
-		
-		// now, place the cells	
-		std::cout << "Writing " << MAT[0].size() << " cells ... " <<std::endl; 
+	
+	// render each scene as it is written (the render launchers start 
+	// before the pinning, so each render's child may use every CPU) 
+	
+	if( options.render )
+	{ render_jobs.start( options.threads ); }
+	
+	bool numa = options.numa && options.pipeline == false && watch == false && stream_output == false 
+		&& numa_placement_available( std::cout ); 
+	if( options.pin_threads && options.pipeline == false && numa == false )
+	{ pin_openmp_threads( options.threads , std::cout ); }
+	
+	// Each frame is a task, and so is each block of a decode and each 
+	// chunk of output within a frame, so threads that run out of frames 
+	// help with the frames still in progress. (The pipeline's readers 
+	// are not in a team, so they use spare threads for large files.) 
+	
+	int decode_threads = options.decode_threads; 
+	if( decode_threads < 1 && options.pipeline )
+	{ decode_threads = options.threads / std::max( (int) file_indices.size() , 1 ); }
+	if( decode_threads < 1 )
+	{ decode_threads = options.threads; }
+	if( decode_threads > 1 && options.pipeline )
+	{ std::cout << "Decoding each file with " << decode_threads << " threads ... " << std::endl; }
+	
+	// with a memory budget, frames start only while they fit 
+	
+	if( options.memory_budget > 0 )
+	{ memory_admission.set_budget( (uint64_t) ( options.memory_budget * 1048576.0 ) ); }
+	
+	// read ahead the files of the next few frames 
+	
+	if( options.prefetch && file_indices.size() > 1 )
+	{ frame_prefetcher.start( file_indices , options.threads , options.prefetch_frames ); }
+	
+	// the frame tasks are created (and mostly started) in order, which 
+	// is what the prefetcher reads ahead of 
+	
+	double wall_time = omp_get_wtime(); 
+	unsigned int frames = file_indices.size(); 
+	if( watch )
+	{
+		// render each snapshot as soon as the simulation finishes writing 
+		// it: a thread of its own waits for them, so every thread of the 
+		// (warm) team renders, even a team of one 
+		frames = 0; 
+		Bounded_Queue<int> snapshots( 1024 ); 
+		std::thread watcher( [&]()
+		{
+			watch_snapshots( [&]( int index )
+			{
+				frames++; 
+				snapshots.push( index ); 
+			} , std::cout ); 
+			snapshots.close(); 
+		} ); 
 		
-		plot_all_cells(os,MAT);
-		os.close(); 
+		#pragma omp parallel 
+		{
+			int index; 
+			double waited; 
+			while( snapshots.pop( index , &waited ) )
+			{
+				std::vector<int> frame( 1 , index ); 
+				process_frame( frame , 0 , options.threads ); 
+			}
+		}
+		watcher.join(); 
+	}
+	else if( stream_output )
+	{
+		// one frame at a time, with the team's threads on its decode and 
+		// output chunks 
+		#pragma omp parallel 
+		#pragma omp single 
+		for( int n =0 ; n < file_indices.size() ; n++ )
+		{ process_frame( file_indices , n , decode_threads ); }
+	}
+	else if( options.pipeline )
+	{ run_pipeline( file_indices , decode_threads ); }
+	else
+	{
+		// on NUMA nodes' own threads and queues if asked for, else as 
+		// frame tasks 
 		
-		std::cout << "done!" << std::endl << std::endl ; 
+		bool numa_done = numa && run_numa_frames( file_indices.size() , options.threads , 
+			[&]( unsigned int n ){ process_frame( file_indices , n , decode_threads ); } ); 
+		if( numa_done == false )
+		{
+			#pragma omp parallel 
+			#pragma omp single 
+			#pragma omp taskloop grainsize( 1 ) 
+			for( int n =0 ; n < file_indices.size() ; n++ )
+			{ process_frame( file_indices , n , decode_threads ); }
+		}
+	}
+	render_jobs.finish( std::cout ); 
+	
+	if( options.prefetch && file_indices.size() > 1 )
+	{
+		std::cout << "Prefetched up to " << frame_prefetcher.lookahead() << " frames ahead." << std::endl; 
+		frame_prefetcher.stop(); 
 	}
 	
-	std::cout << "Done processing all " << file_indices.size() << " files!" << std::endl << std::endl; 
+	if( memory_admission.enabled() )
+	{ memory_admission.display( std::cout ); }
+	display_allocation_statistics( std::cout ); 
+	display_page_fault_statistics( std::cout ); 
+	frame_manifest.close(); 
+	frame_journal.close(); 
+	
+	wall_time = omp_get_wtime() - wall_time; 
+	std::cout << "Processed " << frames << " files in " << wall_time << " seconds with " 
+		<< options.threads << " threads (" << frames / wall_time << " files per second)." << std::endl; 
+	
+	std::cout << "Done processing all " << frames << " files!" << std::endl << std::endl; 
 	
 	return 0;
 }
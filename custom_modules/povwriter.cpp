@@ -65,7 +65,17 @@
 ###############################################################################
 */
 
+#include <sstream>
+#include <algorithm>
+#include <omp.h>
+
 #include "povwriter.h" 
+#include "povwriter_cache.h" 
+#include "povwriter_archive.h" 
+#include "povwriter_compressed.h" 
+#include "povwriter_prefetch.h" 
+#include "povwriter_tar.h" 
+#include "povwriter_topology.h" 
 
 // globals 
 
@@ -76,11 +86,11 @@ pugi::xml_node config_root;
 Options options; 
 std::vector<Cell_Colors> cell_color_definitions; 
 
-void (*pigment_and_finish_function)(Cell_Colorset&,std::vector<std::vector<double>>&,int); 
+void (*pigment_and_finish_function)(Cell_Colorset&,std::vector<std::vector<cell_real>>&,int); 
 
 std::string VERSION = "1.0.0"; 
 
-void plot_cell( std::ostream& os, std::vector<std::vector<double>>& MAT, int i )
+void plot_cell( std::ostream& os, std::vector<std::vector<cell_real>>& MAT, int i )
 {
 	// bookkeeping 
 	Cell_Colorset colors; 
@@ -192,7 +202,7 @@ void plot_cell( std::ostream& os, std::vector<std::vector<double>>& MAT, int i )
 	// offset the nuclear clipping just tiny bit, to avoid 
 	// graphical artifacts where the cytoplasm and nucleus 
 	// blend into each other 
-	static double nuclear_offset = options.nuclear_offset; 
+	double nuclear_offset = options.nuclear_offset; // not static: the server overrides it per request 
 	
 	for( int i=0; i < default_POV_options.clipping_planes.size() ; i++ )
 	{
@@ -244,9 +254,10 @@ void plot_cell( std::ostream& os, std::vector<std::vector<double>>& MAT, int i )
 			// if( intersection_indices.size() > 1 )
 			{ os << "}" << std::endl; }
 		}
-		default_POV_options.no_shadow = true; 
-		Write_POV_sphere( os, center, radius, colors.nuclear_pigment, colors.finish ); 
-		default_POV_options.no_shadow = false; 
+		// nuclei cast no shadows (passed explicitly, since other threads 
+		// may be writing spheres with the default options at the same time) 
+		Write_POV_sphere( os, center, radius, colors.nuclear_pigment, colors.finish , 
+			true , default_POV_options.no_reflection ); 
 	}
 
 	if( intersect )
@@ -255,12 +266,14 @@ void plot_cell( std::ostream& os, std::vector<std::vector<double>>& MAT, int i )
 	return; 
 }
 
-void plot_all_cells( std::ostream& os , std::vector<std::vector<double>>& MAT )
+void plot_cells( std::ostream& os , std::vector<std::vector<cell_real>>& MAT , int first , int last , std::vector<char>* keep )
 {
-	static double bound = options.cell_bound;  
+	double bound = options.cell_bound; // not static: the server overrides it per request 
 	
-	for( int i = 0 ; i < MAT[0].size() ; i++ )
+	for( int i = first ; i < last ; i++ )
 	{
+		if( keep != NULL && (*keep)[i] == 0 )
+		{ continue; }
 		if( MAT[1][i] > -bound && MAT[1][i] < bound &&
 		MAT[2][i] > -bound && MAT[2][i] < bound &&
 		MAT[3][i] > -bound && MAT[3][i] < bound )
@@ -272,7 +285,47 @@ void plot_all_cells( std::ostream& os , std::vector<std::vector<double>>& MAT )
 	return; 
 }
 
-void cancer_immune_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i ) 
+void plot_all_cells( std::ostream& os , std::vector<std::vector<cell_real>>& MAT , std::vector<char>* keep )
+{
+	int cells = MAT[0].size(); 
+	int grain = options.task_grain; 
+	
+	// outside a parallel region (or for small frames), write directly 
+	if( grain < 1 || cells <= grain || omp_in_parallel() == false )
+	{
+		plot_cells( os , MAT , 0 , cells , keep ); 
+		return; 
+	}
+	
+	// Otherwise, write each chunk of cells in its own task, so that idle 
+	// threads of the team can help with a large frame, and then append 
+	// the chunks in order. 
+	
+	int chunks = ( cells + grain - 1 ) / grain; 
+	std::vector<std::string> text( chunks ); 
+	
+	#pragma omp taskloop grainsize( 1 ) shared( text , MAT )
+	for( int c = 0 ; c < chunks ; c++ )
+	{
+		std::ostringstream chunk_os; 
+		plot_cells( chunk_os , MAT , c*grain , std::min( cells , (c+1)*grain ) , keep ); 
+		text[c] = chunk_os.str(); 
+	}
+	
+	for( int c = 0 ; c < chunks ; c++ )
+	{ os << text[c]; }
+	
+	return; 
+}
+
+void write_frame( std::ostream& os , std::vector<std::vector<cell_real>>& MAT )
+{
+	Write_POV_start( os ); 
+	plot_all_cells( os , MAT ); 
+	return; 
+}
+
+void cancer_immune_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i ) 
 {
 	// first, some housekeeping
 	static int type_index = 5; //column that stores cell type (integer)
@@ -351,7 +404,7 @@ void cancer_immune_pigment_and_finish_function( Cell_Colorset& colors, std::vect
 	return; 
 }
 
-void standard_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i ) 
+void standard_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i ) 
 {
 	// first, some housekeeping
 	static int type_index = 5; //column that stores cell type (integer)
@@ -456,6 +509,24 @@ bool load_config_file( std::string filename )
 	options.folder = xml_get_string_value( node, "folder" ) ;
 	options.filebase = xml_get_string_value( node, "filebase" ) ;
 	options.time_index = xml_get_int_value( node, "time_index" ) ; 
+	if( xml_find_node( node , "tar" ) )
+	{ options.tar = xml_get_string_value( node, "tar" ); }
+	if( xml_find_node( node , "archive" ) )
+	{
+		options.archive = xml_get_string_value( node, "archive" ); 
+		pugi::xml_attribute interval = xml_find_node( node , "archive" ).attribute( "keyframe_interval" ); 
+		if( interval )
+		{ options.archive_keyframe_interval = interval.as_int(); }
+	}
+	if( xml_find_node( node , "incremental" ) )
+	{
+		options.incremental = xml_get_bool_value( node, "incremental" ); 
+		pugi::xml_attribute manifest = xml_find_node( node , "incremental" ).attribute( "manifest" ); 
+		if( manifest )
+		{ options.manifest = manifest.as_string(); }
+	}
+	if( xml_find_node( node , "journal" ) )
+	{ options.journal = xml_get_string_value( node, "journal" ); }
 	
 	char temp [1024]; 
 	sprintf( temp , "./%s/%s%08i_cells_physicell.mat" , options.folder.c_str(), options.filebase.c_str() , options.time_index );
@@ -476,7 +547,85 @@ bool load_config_file( std::string filename )
 	}
 	options.nuclear_offset = xml_get_double_value( node, "nuclear_offset" ); 
 	options.cell_bound = xml_get_double_value( node, "cell_bound" ); 
-	options.threads = xml_get_int_value( node, "threads" ); 
+	if( xml_get_string_value( node, "threads" ) == "auto" )
+	{ options.threads = automatic_thread_count( std::cout ); }
+	else
+	{ options.threads = xml_get_int_value( node, "threads" ); }
+	if( xml_find_node( node , "threads" ).attribute( "pin" ) )
+	{ options.pin_threads = xml_find_node( node , "threads" ).attribute( "pin" ).as_bool(); }
+	if( xml_find_node( node , "numa" ) )
+	{ options.numa = xml_get_bool_value( node, "numa" ); }
+	if( xml_find_node( node , "decode_threads" ) )
+	{ options.decode_threads = xml_get_int_value( node, "decode_threads" ); }
+	if( xml_find_node( node , "task_grain" ) )
+	{ options.task_grain = xml_get_int_value( node, "task_grain" ); }
+	if( xml_find_node( node , "frame_arena" ) )
+	{
+		options.frame_arena = xml_get_bool_value( node, "frame_arena" ); 
+		if( xml_find_node( node , "frame_arena" ).attribute( "size" ) )
+		{ options.frame_arena_size = xml_find_node( node , "frame_arena" ).attribute( "size" ).as_int(); }
+	}
+	if( xml_find_node( node , "memory_budget" ) )
+	{ options.memory_budget = xml_get_double_value( node, "memory_budget" ); }
+	if( xml_find_node( node , "pipeline" ) )
+	{
+		pugi::xml_node pipeline = xml_find_node( node , "pipeline" ); 
+		options.pipeline = xml_get_bool_value( node, "pipeline" ); 
+		if( pipeline.attribute( "readers" ) )
+		{ options.pipeline_readers = pipeline.attribute( "readers" ).as_int(); }
+		if( pipeline.attribute( "writers" ) )
+		{ options.pipeline_writers = pipeline.attribute( "writers" ).as_int(); }
+		if( pipeline.attribute( "queue" ) )
+		{ options.pipeline_queue = pipeline.attribute( "queue" ).as_int(); }
+	}
+	if( xml_find_node( node , "server_cache" ) )
+	{ options.server_cache = xml_get_double_value( node, "server_cache" ); }
+	if( xml_find_node( node , "tiles" ) )
+	{
+		pugi::xml_node tiles = xml_find_node( node , "tiles" ); 
+		options.tiles = xml_get_bool_value( node, "tiles" ); 
+		if( tiles.attribute( "columns" ) )
+		{ options.tile_columns = tiles.attribute( "columns" ).as_int(); }
+		if( tiles.attribute( "rows" ) )
+		{ options.tile_rows = tiles.attribute( "rows" ).as_int(); }
+		if( tiles.attribute( "width" ) )
+		{ options.image_width = tiles.attribute( "width" ).as_int(); }
+		if( tiles.attribute( "height" ) )
+		{ options.image_height = tiles.attribute( "height" ).as_int(); }
+		if( tiles.attribute( "shadow_casters" ) )
+		{ options.tile_shadow_casters = tiles.attribute( "shadow_casters" ).as_bool(); }
+	}
+	if( xml_find_node( node , "render" ) )
+	{
+		pugi::xml_node render = xml_find_node( node , "render" ); 
+		options.render = xml_get_bool_value( node, "render" ); 
+		if( render.attribute( "command" ) )
+		{ options.render_command = render.attribute( "command" ).as_string(); }
+		if( render.attribute( "threads" ) )
+		{ options.render_threads = render.attribute( "threads" ).as_int(); }
+		if( render.attribute( "keep_pov" ) )
+		{ options.keep_pov = render.attribute( "keep_pov" ).as_bool(); }
+	}
+	if( xml_find_node( node , "prefetch" ) )
+	{
+		options.prefetch = xml_get_bool_value( node, "prefetch" ); 
+		pugi::xml_attribute frames = xml_find_node( node , "prefetch" ).attribute( "frames" ); 
+		if( frames )
+		{ options.prefetch_frames = frames.as_int(); }
+	}
+	if( xml_find_node( node , "render_cache" ) )
+	{
+		options.render_cache = xml_get_bool_value( node, "render_cache" ); 
+		options.render_cache_folder = xml_find_node( node , "render_cache" ).attribute( "folder" ).value(); 
+	}
+	if( xml_find_node( node , "render_cache_columns" ) )
+	{
+		std::vector<double> columns; 
+		csv_to_vector( xml_get_string_value( node, "render_cache_columns" ).c_str() , columns ); 
+		options.render_cache_columns.assign( columns.begin() , columns.end() ); 
+	}
+	if( options.render_cache )
+	{ std::cout << "\tUsing render cache for " << options.render_cache_columns.size() << " columns ... " << std::endl; }
 		
 	// now, set clipping planes 
 	
@@ -568,6 +717,21 @@ bool load_config_file( std::string filename )
 	options.camera_theta = xml_get_double_value( node, "xy_angle" ); 
 	options.camera_phi = xml_get_double_value( node, "yz_angle" ); 
 	
+	// more cameras (each with a name) for more views of every frame 
+	options.cameras.clear(); 
+	for( node = config_root.child( "camera" ) ; node ; node = node.next_sibling( "camera" ) )
+	{
+		Camera_View camera; 
+		camera.name = node.attribute( "name" ) ? node.attribute( "name" ).as_string() 
+			: "camera" + std::to_string( options.cameras.size() ); 
+		camera.distance = xml_get_double_value( node, "distance_from_origin" ); 
+		camera.theta = xml_get_double_value( node, "xy_angle" ); 
+		camera.phi = xml_get_double_value( node, "yz_angle" ); 
+		options.cameras.push_back( camera ); 
+	}
+	if( options.cameras.size() > 1 )
+	{ std::cout << "\tWriting " << options.cameras.size() << " camera views of each frame ... " << std::endl; }
+	
 	return true; 	
 }
 
@@ -577,6 +741,15 @@ Options::Options()
 	filebase = "output"; 
 	time_index = 3696; 
 	filename = "./sample/output0003696_physicell_cells.mat" ; 
+	
+	archive = ""; 
+	tar = ""; 
+	archive_keyframe_interval = 16; 
+	
+	incremental = false; 
+	manifest = "povwriter-manifest.txt"; 
+	journal = "povwriter-journal.txt"; 
+	output = "pov%08i.pov"; 
 
 	double pi = 3.141592653589793;
 
@@ -589,6 +762,41 @@ Options::Options()
 	cell_bound = 750; 
 	
 	threads = 1; 
+	pin_threads = false; 
+	numa = false; 
+	decode_threads = 0; 
+	task_grain = 4096; 
+	memory_budget = 0.0; 
+	frame_arena = false; 
+	frame_arena_size = 4096; 
+	
+	server_cache = 256.0; 
+	
+	pipeline = false; 
+	pipeline_readers = 2; 
+	pipeline_writers = 1; 
+	pipeline_queue = 0; 
+	
+	tiles = false; 
+	tile_columns = 2; 
+	tile_rows = 2; 
+	image_width = 1920; 
+	image_height = 1080; 
+	tile_shadow_casters = true; 
+	
+	render = false; 
+	render_command = "povray -D +FN +W1920 +H1080 +WT{threads} +I{pov} +O{png}"; 
+	render_threads = 2; 
+	keep_pov = false; 
+	
+	prefetch = true; 
+	prefetch_frames = 0; 
+	
+	// ID, position, volume, type, cycle model, nuclear volume, and 
+	// the oncoprotein column used by the cancer-immune coloring 
+	render_cache = false; 
+	render_cache_folder = ""; 
+	render_cache_columns = {0,1,2,3,4,5,6,9,27}; 
 	
 	return; 
 }
@@ -626,6 +834,9 @@ void display_splash( std::ostream& os )
 		<< "               \t\t " << "(Note that there are no spaces.)" << std::endl 
 		<< "               \t\t " << "(See the config file to set FOLDER and FILEBASE)" << std::endl << std::endl 
 		
+		<< "povwriter --pack FILE x:y:z\t: " << "pack the snapshots with these indices into the " << std::endl 
+		<< "               \t\t  " << "archive FILE (render from it by setting <archive>)" << std::endl << std::endl 
+		
 		<< "Code updates at https://github.com/PhysiCell-Tools/PhysiCell-povwriter " << std::endl << std::endl 
 		
 		<< "Tutorial & documentation at http://MathCancer.org/blog/povwriter " << std::endl 
@@ -667,7 +878,124 @@ std::string create_filename( int index )
 	return create_filename( options.folder, options.filebase , index );
 }
 
+// finds the index field of an output pattern: %[flags][width][.precision] 
+// then d or i. "%%" is a literal %. 
+static int find_output_index_fields( std::string pattern , size_t* start , size_t* length )
+{
+	int fields = 0; 
+	for( size_t k=0; k < pattern.size() ; k++ )
+	{
+		if( pattern[k] != '%' )
+		{ continue; }
+		if( k+1 < pattern.size() && pattern[k+1] == '%' )
+		{
+			k++; 
+			continue; 
+		}
+		size_t end = pattern.find_first_not_of( "-+ #0123456789." , k+1 ); 
+		if( end == std::string::npos || ( pattern[end] != 'd' && pattern[end] != 'i' ) )
+		{ return -1; }
+		*start = k; 
+		*length = end+1 - k; 
+		fields++; 
+		k = end; 
+	}
+	return fields; 
+}
+
+int output_index_fields( std::string pattern )
+{
+	size_t start; 
+	size_t length; 
+	return find_output_index_fields( pattern , &start , &length ); 
+}
+
+// the pattern's text, with "%%" as "%" 
+static std::string output_pattern_text( std::string text )
+{
+	std::string out; 
+	for( size_t k=0; k < text.size() ; k++ )
+	{
+		out += text[k]; 
+		if( text[k] == '%' && k+1 < text.size() && text[k+1] == '%' )
+		{ k++; }
+	}
+	return out; 
+}
+
+std::string create_output_filename( int index )
+{
+	// only the index field goes through printf (see output_index_fields) 
+	size_t start = 0; 
+	size_t length = 0; 
+	if( find_output_index_fields( options.output , &start , &length ) != 1 )
+	{ return output_pattern_text( options.output ); }
+	
+	char field [64]; 
+	snprintf( field , sizeof(field) , options.output.substr( start , length ).c_str() , index ); 
+	return output_pattern_text( options.output.substr( 0 , start ) ) + field 
+		+ output_pattern_text( options.output.substr( start+length ) ); 
+}
+
+
+
+void setup_POV_camera( void )
+{
+	default_POV_options.set_camera_from_spherical_location( options.camera_distance , options.camera_theta, options.camera_phi ); //  1500, 5*pi/4.0 , pi/3.0 ); // do
+	default_POV_options.light_position[0] *= 0.5; 
+	return; 
+}
 
+bool read_cell_data( int index , std::vector<std::vector<cell_real>>& MAT , int decode_threads )
+{
+	if( snapshot_archive.is_open() )
+	{ return snapshot_archive.read( index , MAT ); }
+	if( tar_archive.is_open() )
+	{ return tar_archive.read_matlab( create_filename( index ) , MAT ); }
+	
+	return read_snapshot_file( find_snapshot_file( create_filename( index ) ) , MAT , decode_threads ); 
+}
+
+bool read_snapshot_file( std::string filename , std::vector<std::vector<cell_real>>& MAT , int decode_threads )
+{
+	if( options.render_cache && read_render_cache( filename , MAT ) )
+	{ return true; }
+	
+	bool read_ok; 
+	if( snapshot_compression( filename ) != compression_none )
+	{ read_ok = read_compressed_matlab( filename , MAT , decode_threads ); }
+	else if( decode_threads > 1 )
+	{ read_ok = read_matlab_parallel( filename , decode_threads , MAT ); }
+	else
+	{ read_ok = read_matlab( filename , MAT , NULL ); }
+	if( read_ok == false || MAT.size() == 0 )
+	{ return false; }
+	
+	if( options.render_cache )
+	{ write_render_cache( filename , MAT ); }
+	
+	return true; 
+}
+
+void prefetch_cell_data( int index )
+{
+	if( snapshot_archive.is_open() )
+	{
+		snapshot_archive.prefetch( index ); 
+		return; 
+	}
+	if( tar_archive.is_open() )
+	{
+		tar_archive.prefetch( create_filename( index ) ); 
+		return; 
+	}
+	
+	std::string filename = find_snapshot_file( create_filename( index ) ); 
+	if( options.render_cache && render_cache_is_valid( filename ) )
+	{ filename = render_cache_filename( filename ); }
+	prefetch_file( filename , 0 , 0 ); 
+	return; 
+}
 
 std::vector<int> create_index_list( char* input )
 {
@@ -720,11 +1048,13 @@ std::vector<int> create_index_list( char* input )
 		return output; 
 	}	
 	
+	// a single index 
+	output.push_back( atoi(input) ); 
 	return output; 
 }
 
 
-void my_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i )
+void my_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i )
 {
 	// first, some housekeeping
 	static int type_index = 5; //column that stores cell type (integer)
@@ -65,6 +65,9 @@
 ###############################################################################
 */
 
+#ifndef __povwriter_h__
+#define __povwriter_h__
+
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
@@ -81,12 +84,31 @@
 using namespace BioFVM; 
 using namespace PhysiCell; 
 
+// Cell data are stored in double precision by default. Build with 
+// "make FLOAT32=1" to store them in single precision instead, which 
+// halves the memory of each frame in flight. 
+
+#ifdef POVWRITER_FLOAT32
+typedef float cell_real; 
+#else
+typedef double cell_real; 
+#endif
+
 extern bool config_dom_initialized; 
 extern pugi::xml_document config_doc; 	
 extern pugi::xml_node config_root; 
 
 extern std::string VERSION; 
 
+class Camera_View
+{
+ public:
+	std::string name; 
+	double distance; 
+	double theta; 
+	double phi; 
+}; 
+
 class Options
 {
  public:
@@ -95,14 +117,57 @@ class Options
 	std::string filename; 
 	int time_index; 
 	
+	std::string archive; // if set, read snapshots from this archive 
+	std::string tar; // if set, read snapshots from this tar file 
+	int archive_keyframe_interval; 
+	
+	bool incremental; // skip frames whose manifest entry is current 
+	std::string manifest; 
+	std::string journal; // finished frames, for --resume; empty: none 
+	std::string output; // scene file name pattern (-o); "-": stdout 
+	
 	double camera_distance; 
 	double camera_theta;
 	double camera_phi; 
+	std::vector<Camera_View> cameras; // every <camera>; two or more: a scene per camera 
 	
 	double nuclear_offset;
 	double cell_bound; 
 	
-	int threads; 
+	int threads; // "auto" in the config: from the affinity mask and cgroup quota 
+	bool pin_threads; 
+	bool numa; // per-node threads and frame queues (make NUMA=1) 
+	int decode_threads; // threads that share the decoding of a single file 
+	int task_grain; // cells per output task within a frame; 0: one task per frame 
+	double memory_budget; // MB for all frames in flight; 0: no limit 
+	bool frame_arena; // per-thread arenas for each frame's allocations 
+	int frame_arena_size; // MB of address space per thread 
+	
+	double server_cache; // MB of decoded frames kept by --serve 
+	
+	bool pipeline; // separate reader, render, and writer threads 
+	int pipeline_readers; 
+	int pipeline_writers; 
+	int pipeline_queue; // frames per queue; 0: one per render thread 
+	
+	bool tiles; // a culled scene and .ini per tile of the image 
+	int tile_columns; 
+	int tile_rows; 
+	int image_width; 
+	int image_height; 
+	bool tile_shadow_casters; // keep the cells that may shadow a tile's cells 
+	
+	bool render; // run render_command on each finished scene 
+	std::string render_command; 
+	int render_threads; // cores per render 
+	bool keep_pov; // else delete each scene once it has rendered 
+	
+	bool prefetch; 
+	int prefetch_frames; // 0: tune from measured read vs. render times 
+	
+	bool render_cache; 
+	std::string render_cache_folder; // empty: next to each .mat file 
+	std::vector<int> render_cache_columns; 
 	
 	Options(); 
 };
@@ -134,22 +199,45 @@ extern std::vector<Cell_Colors> cell_color_definitions;
 
 bool load_config_file( std::string filename ); 
 void setup_cell_color_definitions( void ); 
+void setup_POV_camera( void ); // from the loaded options 
 
-extern void (*pigment_and_finish_function)(Cell_Colorset&,std::vector<std::vector<double>>&,int); 
+extern void (*pigment_and_finish_function)(Cell_Colorset&,std::vector<std::vector<cell_real>>&,int); 
 	
-void cancer_immune_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i ); 
-void standard_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i );  
-void my_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<double>>& MAT, int i ); 
+void cancer_immune_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i ); 
+void standard_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i );  
+void my_pigment_and_finish_function( Cell_Colorset& colors, std::vector<std::vector<cell_real>>& MAT, int i ); 
 
-void plot_cell( std::ostream& os, std::vector<std::vector<double>>& MAT, int i );
+void plot_cell( std::ostream& os, std::vector<std::vector<cell_real>>& MAT, int i );
 
-void plot_all_cells( std::ostream& os , std::vector<std::vector<double>>& MAT );
+// plot cells first to last-1 (only those with keep[i] nonzero, if given) 
+void plot_cells( std::ostream& os , std::vector<std::vector<cell_real>>& MAT , int first , int last , std::vector<char>* keep = NULL ); 
+void plot_all_cells( std::ostream& os , std::vector<std::vector<cell_real>>& MAT , std::vector<char>* keep = NULL );
+
+// the whole scene of a frame: camera and lights, then all the cells 
+void write_frame( std::ostream& os , std::vector<std::vector<cell_real>>& MAT ); 
+std::string create_output_filename( int index ); 
+// the index fields (%d or %i, with flags and width) of an output pattern; 
+// -1 if it has any other conversion 
+int output_index_fields( std::string pattern ); 
 
 void display_splash( std::ostream& os ); 
 
 bool is_xml( std::string filename ); 
 bool is_xml( char* filename ); 
 
+// read the cell data of snapshot (time) index: from the archive if one is 
+// open, else from the render cache if enabled and current, else the .mat 
+// (or compressed .mat.gz / .mat.zst) file 
+bool read_cell_data( int index , std::vector<std::vector<cell_real>>& MAT , int decode_threads ); 
+
+// the same, for the snapshot file itself (after find_snapshot_file) 
+bool read_snapshot_file( std::string filename , std::vector<std::vector<cell_real>>& MAT , int decode_threads ); 
+
+// ask the kernel to read ahead whatever read_cell_data( index ) will read 
+void prefetch_cell_data( int index ); 
+
 std::vector<int> create_index_list( char* input ); 
 std::string create_filename( std::string folder, std::string filebase , int index ); 
-std::string create_filename( int index ); 
+std::string create_filename( int index );
+
+#endif
@@ -0,0 +1,210 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_admission.h" 
+#include "povwriter_archive.h" 
+#include "povwriter_tar.h" 
+#include "povwriter_compressed.h" 
+#include "povwriter_buffers.h" 
+
+#include <algorithm>
+#include <chrono>
+
+Memory_Admission memory_admission; 
+
+// measured: about 290 bytes of POV-Ray text per cell (cytoplasm and nucleus) 
+static const uint64_t scene_bytes_per_cell = 320; 
+
+Memory_Admission::Memory_Admission()
+{
+	budget = 0; 
+	in_use = 0; 
+	peak = 0; 
+	next_ticket = 0; 
+	now_serving = 0; 
+	frames_waited = 0; 
+	seconds_waited = 0.0; 
+	return; 
+}
+
+void Memory_Admission::set_budget( uint64_t bytes )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	budget = bytes; 
+	return; 
+}
+
+bool Memory_Admission::enabled( void )
+{ return budget > 0; }
+
+void Memory_Admission::admit( uint64_t bytes )
+{
+	std::unique_lock<std::mutex> lock( mutex ); 
+	uint64_t ticket = next_ticket++; 
+	
+	// wait for our turn, and for room (or for nothing else in flight) 
+	bool waited = false; 
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); 
+	while( ticket != now_serving || ( in_use > 0 && in_use + bytes > budget ) )
+	{
+		waited = true; 
+		condition.wait( lock ); 
+	}
+	if( waited )
+	{
+		frames_waited++; 
+		seconds_waited += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); 
+	}
+	if( bytes > budget )
+	{
+		std::cout << "Warning: a frame needs an estimated " << bytes / 1048576.0 << " MB, more than the whole memory budget (" 
+			<< budget / 1048576.0 << " MB); running it on its own ... " << std::endl; 
+	}
+	
+	in_use += bytes; 
+	peak = std::max( peak , in_use ); 
+	now_serving++; 
+	lock.unlock(); 
+	condition.notify_all(); 
+	return; 
+}
+
+void Memory_Admission::release( uint64_t bytes )
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		in_use -= bytes; 
+	}
+	condition.notify_all(); 
+	return; 
+}
+
+void Memory_Admission::display( std::ostream& os )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	os << "Memory budget: " << budget / 1048576.0 << " MB; peak estimated use " << peak / 1048576.0 << " MB; " 
+		<< frames_waited << " frames waited " << seconds_waited << " seconds for memory." << std::endl; 
+	return; 
+}
+
+bool cell_data_dimensions( int index , uint64_t* rows , uint64_t* cells )
+{
+	if( snapshot_archive.is_open() )
+	{ return snapshot_archive.dimensions( index , rows , cells ); }
+	if( tar_archive.is_open() )
+	{ return tar_archive.matlab_dimensions( create_filename( index ) , rows , cells ); }
+	
+	std::string filename = find_snapshot_file( create_filename( index ) ); 
+	if( snapshot_compression( filename ) != compression_none )
+	{ return read_compressed_matlab_dimensions( filename , rows , cells ); }
+	
+	unsigned int matlab_rows; 
+	unsigned int matlab_cols; 
+	FILE* fp = read_matlab_header( &matlab_rows , &matlab_cols , filename ); 
+	if( fp == NULL )
+	{ return false; }
+	fclose( fp ); 
+	*rows = matlab_rows; 
+	*cells = matlab_cols; 
+	return true; 
+}
+
+uint64_t estimate_frame_memory( int index )
+{
+	uint64_t rows; 
+	uint64_t cells; 
+	if( cell_data_dimensions( index , &rows , &cells ) == false )
+	{ return 0; } // the read will fail (and say so) anyway 
+	
+	// the cell data 
+	uint64_t bytes = rows * cells * sizeof( cell_real ); 
+	
+	// decode buffers: archives decode whole frames (and keyframe 
+	// positions) in double precision, and multi-frame zstd files are 
+	// decompressed whole; other reads go through ~1 MB blocks per thread 
+	uint64_t raw_bytes = rows * cells * sizeof( double ); 
+	std::string filename = find_snapshot_file( create_filename( index ) ); 
+	if( snapshot_archive.is_open() )
+	{ bytes += raw_bytes + 3 * cells * sizeof( double ); }
+	else if( tar_archive.is_open() == false && snapshot_compression( filename ) != compression_none )
+	{ bytes += raw_bytes; }
+	else
+	{ bytes += std::min( raw_bytes , (uint64_t) std::max( options.threads , 1 ) << 20 ); }
+	
+	// the scene text: the pipeline holds it (and a copy) until written, 
+	// and chunked frames hold all chunks until appended; otherwise it goes 
+	// to the file a few MB at a time 
+	uint64_t text_bytes = scene_bytes_per_cell * cells; 
+	if( options.pipeline )
+	{ bytes += 2 * text_bytes; }
+	else if( options.task_grain > 0 && cells > (uint64_t) options.task_grain )
+	{ bytes += text_bytes + std::min( text_bytes , (uint64_t) frame_output_chunk_size ); }
+	else
+	{ bytes += std::min( text_bytes , (uint64_t) frame_output_chunk_size ); }
+	
+	return bytes; 
+}
@@ -0,0 +1,627 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_archive.h" 
+
+#include <cmath>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char archive_magic[8] = {'P','O','V','A','R','C','H','V'}; 
+static const uint32_t archive_version = 1; 
+
+// column encodings 
+
+static const unsigned char ENCODING_RAW = 0; // cells doubles 
+static const unsigned char ENCODING_DICTIONARY_RLE = 1; // dictionary, then (entry,run length) pairs 
+static const unsigned char ENCODING_XOR_DELTA = 2; // XOR against the keyframe value of the same cell ID 
+static const unsigned char ENCODING_INTEGER_DELTA = 3; // zigzag varint differences of integers 
+
+Snapshot_Archive snapshot_archive; 
+
+// little helpers for variable-length integers 
+
+static void write_varint( std::vector<unsigned char>& out , uint64_t value )
+{
+	while( value >= 128 )
+	{
+		out.push_back( (unsigned char) ( value | 128 ) ); 
+		value >>= 7; 
+	}
+	out.push_back( (unsigned char) value ); 
+	return; 
+}
+
+static bool read_varint( const unsigned char*& p , const unsigned char* end , uint64_t& value )
+{
+	value = 0; 
+	int shift = 0; 
+	while( p < end && shift < 64 )
+	{
+		unsigned char byte = *p++; 
+		value |= ( (uint64_t) ( byte & 127 ) ) << shift; 
+		if( byte < 128 )
+		{ return true; }
+		shift += 7; 
+	}
+	return false; 
+}
+
+static uint64_t zigzag( int64_t value )
+{ return ( (uint64_t) value << 1 ) ^ (uint64_t) ( value >> 63 ); }
+
+static int64_t unzigzag( uint64_t value )
+{ return (int64_t) ( value >> 1 ) ^ -(int64_t) ( value & 1 ); }
+
+static uint64_t double_bits( double value )
+{
+	uint64_t bits; 
+	memcpy( &bits , &value , 8 ); 
+	return bits; 
+}
+
+static double bits_double( uint64_t bits )
+{
+	double value; 
+	memcpy( &value , &bits , 8 ); 
+	return value; 
+}
+
+static bool is_position_row( unsigned int row )
+{ return row >= 1 && row <= 3; }
+
+// encoders 
+
+static void encode_raw( std::vector<double>& column , std::vector<unsigned char>& out )
+{
+	size_t start = out.size(); 
+	out.resize( start + column.size()*sizeof(double) ); 
+	memcpy( out.data() + start , column.data() , column.size()*sizeof(double) ); 
+	return; 
+}
+
+// returns false (leaving out unchanged) if the column has too many distinct 
+// values, or if the encoding would not be smaller than raw storage 
+
+static bool encode_dictionary_rle( std::vector<double>& column , std::vector<unsigned char>& out )
+{
+	std::vector<uint64_t> dictionary; 
+	std::unordered_map<uint64_t,uint64_t> lookup; 
+	std::vector<unsigned char> runs; 
+	
+	size_t raw_size = column.size()*sizeof(double); 
+	uint64_t i = 0; 
+	while( i < column.size() )
+	{
+		uint64_t bits = double_bits( column[i] ); 
+		uint64_t j = i+1; 
+		while( j < column.size() && double_bits( column[j] ) == bits )
+		{ j++; }
+		
+		std::unordered_map<uint64_t,uint64_t>::iterator it = lookup.find( bits ); 
+		uint64_t entry; 
+		if( it == lookup.end() )
+		{
+			entry = dictionary.size(); 
+			dictionary.push_back( bits ); 
+			lookup[bits] = entry; 
+			if( dictionary.size() > 65536 )
+			{ return false; }
+		}
+		else
+		{ entry = it->second; }
+		
+		write_varint( runs , entry ); 
+		write_varint( runs , j-i ); 
+		if( runs.size() + dictionary.size()*sizeof(double) >= raw_size )
+		{ return false; }
+		i = j; 
+	}
+	
+	write_varint( out , dictionary.size() ); 
+	size_t start = out.size(); 
+	out.resize( start + dictionary.size()*sizeof(double) ); 
+	memcpy( out.data() + start , dictionary.data() , dictionary.size()*sizeof(double) ); 
+	out.insert( out.end() , runs.begin() , runs.end() ); 
+	return true; 
+}
+
+static bool encode_integer_delta( std::vector<double>& column , std::vector<unsigned char>& out )
+{
+	std::vector<unsigned char> temp; 
+	int64_t previous = 0; 
+	for( uint64_t i=0; i < column.size() ; i++ )
+	{
+		if( column[i] != floor( column[i] ) || fabs( column[i] ) > 9.0e15 )
+		{ return false; }
+		int64_t value = (int64_t) column[i]; 
+		write_varint( temp , zigzag( value - previous ) ); 
+		previous = value; 
+	}
+	out.insert( out.end() , temp.begin() , temp.end() ); 
+	return true; 
+}
+
+// reference[i] is the keyframe value of cell i (or 0 if the cell is new). 
+// Nearby doubles share their sign, exponent, and leading mantissa bits, so 
+// the XOR has leading zero bytes: store the count of remaining low bytes, 
+// then those bytes. 
+
+static void encode_xor_delta( std::vector<double>& column , std::vector<uint64_t>& reference , std::vector<unsigned char>& out )
+{
+	for( uint64_t i=0; i < column.size() ; i++ )
+	{
+		uint64_t x = double_bits( column[i] ) ^ reference[i]; 
+		unsigned char n = 0; 
+		uint64_t y = x; 
+		while( y )
+		{ n++; y >>= 8; }
+		out.push_back( n ); 
+		for( unsigned char k=0; k < n ; k++ )
+		{ out.push_back( (unsigned char) ( x >> (8*k) ) ); }
+	}
+	return; 
+}
+
+// for each cell of MAT, its keyframe value bits in each position row 
+
+static void position_references( std::vector<std::vector<double>>& MAT , std::vector<std::vector<double>>& keyframe , 
+	std::vector<std::vector<uint64_t>>& references )
+{
+	uint64_t cells = MAT[0].size(); 
+	references.assign( 4 , std::vector<uint64_t>( cells , 0 ) ); 
+	
+	std::unordered_map<int64_t,uint64_t> lookup; 
+	lookup.reserve( keyframe[0].size() ); 
+	for( uint64_t i=0; i < keyframe[0].size() ; i++ )
+	{ lookup[ (int64_t) keyframe[0][i] ] = i; }
+	
+	for( uint64_t i=0; i < cells ; i++ )
+	{
+		std::unordered_map<int64_t,uint64_t>::iterator it = lookup.find( (int64_t) MAT[0][i] ); 
+		if( it == lookup.end() )
+		{ continue; }
+		for( unsigned int row=1; row <= 3 ; row++ )
+		{ references[row][i] = double_bits( keyframe[row][it->second] ); }
+	}
+	return; 
+}
+
+static void append_column( std::vector<unsigned char>& out , unsigned char encoding , std::vector<unsigned char>& payload )
+{
+	out.push_back( encoding ); 
+	uint64_t size = payload.size(); 
+	size_t start = out.size(); 
+	out.resize( start + sizeof(uint64_t) ); 
+	memcpy( out.data() + start , &size , sizeof(uint64_t) ); 
+	out.insert( out.end() , payload.begin() , payload.end() ); 
+	return; 
+}
+
+static void encode_frame( std::vector<std::vector<double>>& MAT , std::vector<std::vector<double>>* keyframe , 
+	std::vector<unsigned char>& out )
+{
+	out.clear(); 
+	
+	std::vector<std::vector<uint64_t>> references; 
+	bool delta = ( keyframe != NULL && MAT.size() > 3 && keyframe->size() > 3 ); 
+	if( delta )
+	{ position_references( MAT , *keyframe , references ); }
+	
+	std::vector<unsigned char> payload; 
+	for( unsigned int row=0; row < MAT.size() ; row++ )
+	{
+		payload.clear(); 
+		unsigned char encoding = ENCODING_RAW; 
+		
+		if( delta && is_position_row( row ) )
+		{
+			encode_xor_delta( MAT[row] , references[row] , payload ); 
+			encoding = ENCODING_XOR_DELTA; 
+		}
+		else if( row == 0 && encode_integer_delta( MAT[row] , payload ) )
+		{ encoding = ENCODING_INTEGER_DELTA; }
+		else if( encode_dictionary_rle( MAT[row] , payload ) )
+		{ encoding = ENCODING_DICTIONARY_RLE; }
+		else
+		{ encode_raw( MAT[row] , payload ); }
+		
+		append_column( out , encoding , payload ); 
+	}
+	return; 
+}
+
+bool write_snapshot_archive( std::string filename , std::vector<int>& indices , unsigned int keyframe_interval )
+{
+	if( keyframe_interval < 1 )
+	{ keyframe_interval = 1; }
+	
+	FILE* fp = fopen( filename.c_str() , "wb" ); 
+	if( fp == NULL )
+	{
+		std::cout << "Error: could not open " << filename << " for writing!" << std::endl; 
+		return false; 
+	}
+	
+	Archive_Header header; 
+	memset( &header , 0 , sizeof(Archive_Header) ); 
+	memcpy( header.magic , archive_magic , 8 ); 
+	header.version = archive_version; 
+	header.keyframe_interval = keyframe_interval; 
+	fwrite( &header , sizeof(Archive_Header) , 1 , fp ); 
+	
+	std::vector<Archive_Frame> frames; 
+	std::vector<std::vector<double>> keyframe; 
+	std::vector<unsigned char> buffer; 
+	uint64_t raw_bytes = 0; 
+	
+	for( unsigned int n=0; n < indices.size() ; n++ )
+	{
+		std::string source = create_filename( indices[n] ); 
+		std::vector<std::vector<double>> MAT; 
+		if( read_matlab( source , MAT , NULL ) == false || MAT.size() == 0 )
+		{
+			std::cout << "Skipping " << source << " ... " << std::endl; 
+			continue; 
+		}
+		
+		Archive_Frame frame; 
+		memset( &frame , 0 , sizeof(Archive_Frame) ); 
+		frame.index = indices[n]; 
+		frame.rows = MAT.size(); 
+		frame.cells = MAT[0].size(); 
+		frame.offset = ftello( fp ); 
+		
+		bool is_keyframe = ( frames.size() % keyframe_interval == 0 ); 
+		if( is_keyframe )
+		{
+			frame.keyframe = frames.size(); 
+			encode_frame( MAT , NULL , buffer ); 
+			keyframe.swap( MAT ); 
+		}
+		else
+		{
+			frame.keyframe = frames[ frames.size()-1 ].keyframe; 
+			encode_frame( MAT , &keyframe , buffer ); 
+		}
+		frame.size = buffer.size(); 
+		
+		if( fwrite( buffer.data() , 1 , buffer.size() , fp ) != buffer.size() )
+		{
+			std::cout << "Error: could not write to " << filename << "!" << std::endl; 
+			fclose( fp ); 
+			return false; 
+		}
+		frames.push_back( frame ); 
+		raw_bytes += frame.rows * frame.cells * sizeof(double); 
+		
+		std::cout << "Packed " << source << " (" << frame.cells << " cells, " 
+			<< ( is_keyframe ? "keyframe" : "delta" ) << ") ... " << std::endl; 
+	}
+	
+	// write the frame index, then point the header at it 
+	
+	header.index_offset = ftello( fp ); 
+	header.number_of_frames = frames.size(); 
+	if( frames.size() > 0 )
+	{ fwrite( frames.data() , sizeof(Archive_Frame) , frames.size() , fp ); }
+	uint64_t archive_bytes = ftello( fp ); 
+	fseeko( fp , 0 , SEEK_SET ); 
+	fwrite( &header , sizeof(Archive_Header) , 1 , fp ); 
+	
+	if( fclose( fp ) != 0 )
+	{
+		std::cout << "Error: could not write to " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	std::cout << "Wrote " << frames.size() << " frames to " << filename << " (" << archive_bytes 
+		<< " bytes; " << raw_bytes << " bytes of matrix data)" << std::endl; 
+	return true; 
+}
+
+Snapshot_Archive::Snapshot_Archive()
+{
+	fd = -1; 
+	filename = ""; 
+	memset( &header , 0 , sizeof(Archive_Header) ); 
+	return; 
+}
+
+Snapshot_Archive::~Snapshot_Archive()
+{
+	close(); 
+	return; 
+}
+
+bool Snapshot_Archive::is_open( void )
+{ return fd >= 0; }
+
+void Snapshot_Archive::close( void )
+{
+	if( fd >= 0 )
+	{ ::close( fd ); }
+	fd = -1; 
+	frames.clear(); 
+	return; 
+}
+
+static bool pread_all( int fd , void* buffer , size_t size , off_t offset )
+{
+	size_t done = 0; 
+	while( done < size )
+	{
+		ssize_t result = pread( fd , (char*) buffer + done , size - done , offset + done ); 
+		if( result <= 0 )
+		{ return false; }
+		done += result; 
+	}
+	return true; 
+}
+
+bool Snapshot_Archive::open( std::string filename_in )
+{
+	close(); 
+	filename = filename_in; 
+	
+	fd = ::open( filename.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{
+		std::cout << "Error: could not open archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	if( pread_all( fd , &header , sizeof(Archive_Header) , 0 ) == false || 
+		memcmp( header.magic , archive_magic , 8 ) != 0 || header.version != archive_version )
+	{
+		std::cout << "Error: " << filename << " is not a povwriter archive!" << std::endl; 
+		close(); 
+		return false; 
+	}
+	
+	frames.resize( header.number_of_frames ); 
+	if( frames.size() > 0 && 
+		pread_all( fd , frames.data() , frames.size()*sizeof(Archive_Frame) , header.index_offset ) == false )
+	{
+		std::cout << "Error: could not read the frame index of " << filename << "!" << std::endl; 
+		close(); 
+		return false; 
+	}
+	
+	std::cout << "Using archive " << filename << " (" << frames.size() << " frames) ... " << std::endl; 
+	return true; 
+}
+
+int Snapshot_Archive::find_frame( int index )
+{
+	for( unsigned int n=0; n < frames.size() ; n++ )
+	{
+		if( frames[n].index == index )
+		{ return n; }
+	}
+	return -1; 
+}
+
+bool Snapshot_Archive::dimensions( int index , uint64_t* rows , uint64_t* cells )
+{
+	int n = find_frame( index ); 
+	if( n < 0 )
+	{ return false; }
+	*rows = frames[n].rows; 
+	*cells = frames[n].cells; 
+	return true; 
+}
+
+// decode frame n. For delta frames, keyframe must hold the keyframe's 
+// IDs and positions. With positions_only, only rows 0-3 are decoded. 
+
+bool Snapshot_Archive::read_frame( unsigned int n , std::vector<std::vector<double>>& MAT , 
+	std::vector<std::vector<double>>* keyframe , bool positions_only )
+{
+	Archive_Frame& frame = frames[n]; 
+	std::vector<unsigned char> buffer( frame.size ); 
+	if( pread_all( fd , buffer.data() , frame.size , frame.offset ) == false )
+	{ return false; }
+	
+	const unsigned char* p = buffer.data(); 
+	const unsigned char* end = p + buffer.size(); 
+	
+	unsigned int rows = frame.rows; 
+	if( positions_only && rows > 4 )
+	{ rows = 4; }
+	MAT.assign( rows , std::vector<double>() ); 
+	
+	std::vector<std::vector<uint64_t>> references; 
+	
+	for( unsigned int row=0; row < rows ; row++ )
+	{
+		if( end - p < 9 )
+		{ return false; }
+		unsigned char encoding = *p++; 
+		uint64_t size; 
+		memcpy( &size , p , sizeof(uint64_t) ); 
+		p += sizeof(uint64_t); 
+		if( (uint64_t) ( end - p ) < size )
+		{ return false; }
+		const unsigned char* q = p; 
+		const unsigned char* column_end = p + size; 
+		p = column_end; 
+		
+		std::vector<double>& column = MAT[row]; 
+		column.resize( frame.cells ); 
+		
+		if( encoding == ENCODING_RAW )
+		{
+			if( size != frame.cells*sizeof(double) )
+			{ return false; }
+			memcpy( column.data() , q , size ); 
+		}
+		else if( encoding == ENCODING_INTEGER_DELTA )
+		{
+			int64_t previous = 0; 
+			for( uint64_t i=0; i < frame.cells ; i++ )
+			{
+				uint64_t value; 
+				if( read_varint( q , column_end , value ) == false )
+				{ return false; }
+				previous += unzigzag( value ); 
+				column[i] = (double) previous; 
+			}
+		}
+		else if( encoding == ENCODING_DICTIONARY_RLE )
+		{
+			uint64_t dictionary_size; 
+			if( read_varint( q , column_end , dictionary_size ) == false || 
+				(uint64_t) ( column_end - q ) < dictionary_size*sizeof(double) )
+			{ return false; }
+			std::vector<double> dictionary( dictionary_size ); 
+			memcpy( dictionary.data() , q , dictionary_size*sizeof(double) ); 
+			q += dictionary_size*sizeof(double); 
+			
+			uint64_t i = 0; 
+			while( i < frame.cells )
+			{
+				uint64_t entry; 
+				uint64_t run; 
+				if( read_varint( q , column_end , entry ) == false || read_varint( q , column_end , run ) == false || 
+					entry >= dictionary_size || i + run > frame.cells )
+				{ return false; }
+				std::fill( column.begin() + i , column.begin() + i + run , dictionary[entry] ); 
+				i += run; 
+			}
+		}
+		else if( encoding == ENCODING_XOR_DELTA )
+		{
+			if( keyframe == NULL )
+			{ return false; }
+			if( references.size() == 0 )
+			{ position_references( MAT , *keyframe , references ); }
+			for( uint64_t i=0; i < frame.cells ; i++ )
+			{
+				if( q >= column_end || *q > 8 || column_end - q - 1 < *q )
+				{ return false; }
+				unsigned char bytes = *q++; 
+				uint64_t x = 0; 
+				for( unsigned char k=0; k < bytes ; k++ )
+				{ x |= ( (uint64_t) *q++ ) << (8*k); }
+				column[i] = bits_double( x ^ references[row][i] ); 
+			}
+		}
+		else
+		{ return false; }
+	}
+	return true; 
+}
+
+void Snapshot_Archive::prefetch( int index )
+{
+	int n = find_frame( index ); 
+	if( n < 0 )
+	{ return; }
+	
+	#ifdef POSIX_FADV_WILLNEED
+	Archive_Frame& keyframe = frames[ frames[n].keyframe ]; 
+	posix_fadvise( fd , keyframe.offset , keyframe.size , POSIX_FADV_WILLNEED ); 
+	posix_fadvise( fd , frames[n].offset , frames[n].size , POSIX_FADV_WILLNEED ); 
+	#endif 
+	return; 
+}
+
+bool Snapshot_Archive::read( int index , std::vector<std::vector<cell_real>>& MAT )
+{
+	int n = find_frame( index ); 
+	if( n < 0 )
+	{
+		std::cout << "Error: frame " << index << " is not in archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	std::vector<std::vector<double>> keyframe; 
+	std::vector<std::vector<double>>* reference = NULL; 
+	if( frames[n].keyframe != (uint32_t) n )
+	{
+		if( read_frame( frames[n].keyframe , keyframe , NULL , true ) == false )
+		{
+			std::cout << "Error: could not decode keyframe of frame " << index << "!" << std::endl; 
+			return false; 
+		}
+		reference = &keyframe; 
+	}
+	
+	std::vector<std::vector<double>> data; 
+	if( read_frame( n , data , reference , false ) == false )
+	{
+		std::cout << "Error: could not decode frame " << index << " of archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	MAT.resize( data.size() ); 
+	for( unsigned int row=0; row < data.size() ; row++ )
+	{ MAT[row].assign( data[row].begin() , data[row].end() ); }
+	return true; 
+}
@@ -0,0 +1,151 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_archive_h__
+#define __povwriter_archive_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./povwriter.h" 
+
+// A time-series archive packs a run's snapshots into a single file with a 
+// frame index at the end, so one frame can be read with one seek. 
+// 
+// Every keyframe_interval frames is a keyframe. The cell positions (rows 
+// 1, 2, 3) of the other frames are XOR-delta encoded per cell ID against 
+// their keyframe, so any frame decodes from itself plus (at most) the 
+// position columns of one keyframe. Columns with few distinct values (cell 
+// type, cycle model, ...) are dictionary/run-length encoded, the cell IDs 
+// are delta encoded, and everything else is stored as raw doubles. All 
+// encodings are lossless. 
+// 
+// layout: Archive_Header, frames, then number_of_frames Archive_Frame entries 
+
+class Archive_Header
+{
+ public:
+	char magic[8]; // "POVARCHV"
+	uint32_t version; 
+	uint32_t number_of_frames; 
+	uint64_t index_offset; 
+	uint32_t keyframe_interval; 
+	uint32_t reserved; 
+}; 
+
+class Archive_Frame
+{
+ public:
+	int32_t index; // time index (as in FILEBASE########_cells_physicell.mat) 
+	uint32_t keyframe; // position of this frame's keyframe in the frame index 
+	uint64_t offset; 
+	uint64_t size; 
+	uint32_t rows; 
+	uint32_t reserved; 
+	uint64_t cells; 
+}; 
+
+class Snapshot_Archive
+{
+ private:
+	int fd; 
+	std::vector<Archive_Frame> frames; 
+	
+	bool read_frame( unsigned int n , std::vector<std::vector<double>>& MAT , 
+		std::vector<std::vector<double>>* keyframe , bool positions_only ); 
+ public:
+	std::string filename; 
+	Archive_Header header; 
+	
+	Snapshot_Archive(); 
+	~Snapshot_Archive(); 
+	
+	bool open( std::string filename ); 
+	void close( void ); 
+	bool is_open( void ); 
+	
+	// position of the frame with this time index, or -1 
+	int find_frame( int index ); 
+	
+	// matrix size of the frame with this time index, without decoding it 
+	bool dimensions( int index , uint64_t* rows , uint64_t* cells ); 
+	
+	// decode a single frame. This is thread-safe (it only uses pread). 
+	bool read( int index , std::vector<std::vector<cell_real>>& MAT ); 
+	
+	// ask the kernel to read ahead the bytes of a frame (and its keyframe) 
+	void prefetch( int index ); 
+}; 
+
+extern Snapshot_Archive snapshot_archive; 
+
+// pack the snapshots FOLDER/FILEBASE########_cells_physicell.mat for the 
+// given indices into a single archive 
+bool write_snapshot_archive( std::string filename , std::vector<int>& indices , unsigned int keyframe_interval ); 
+
+#endif 
@@ -0,0 +1,341 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_arena.h" 
+
+#include <new>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+// Everything here runs inside operator new, so none of it may use 
+// operator new itself: arenas live in malloc'd and mmap'd memory, and the 
+// per-thread state is plain thread_local data. 
+
+static const size_t arena_alignment = 16; 
+
+// larger allocations (the scene text's growing buffers, say) go to the 
+// heap: there are few of them, and in a monotonic arena each regrowth 
+// would leave its old buffer behind until the frame ends 
+static const size_t max_arena_allocation = 256 << 10; 
+
+// All arenas are slots of one reserved region, so operator delete tells 
+// arena memory from heap memory with one range check, and finds the 
+// owner by division. 
+static std::mutex region_mutex; 
+static std::atomic<bool> region_reserved( false ); 
+static char* region_base = NULL; 
+static uintptr_t region_size = 0; 
+static size_t slot_capacity = 0; 
+static int region_slots = 0; 
+static Frame_Arena* region_arenas = NULL; 
+static std::atomic<int> number_of_arenas( 0 ); 
+
+static thread_local Frame_Arena* thread_arena = NULL; // this thread's arena, once created 
+static thread_local Frame_Arena* current_arena = NULL; // the arena operator new uses now 
+static thread_local bool in_scope = false; 
+static thread_local uint64_t heap_allocations = 0; 
+static thread_local uint64_t arena_allocations = 0; 
+
+static std::atomic<uint64_t> total_frames( 0 ); 
+static std::atomic<uint64_t> total_heap_allocations( 0 ); 
+static std::atomic<uint64_t> total_arena_allocations( 0 ); 
+static std::atomic<uint64_t> arena_resets( 0 ); 
+static std::atomic<uint64_t> arenas_not_reset( 0 ); 
+static std::atomic<uint64_t> arena_high_water( 0 ); 
+
+void* Frame_Arena::allocate( size_t size )
+{
+	if( size > max_arena_allocation )
+	{ return NULL; }
+	size_t start = ( offset + arena_alignment - 1 ) & ~( arena_alignment - 1 ); 
+	if( start > capacity || size > capacity - start )
+	{ return NULL; }
+	offset = start + ( size > 0 ? size : 1 ); 
+	if( offset > high_water )
+	{ high_water = offset; }
+	live.fetch_add( 1 , std::memory_order_relaxed ); 
+	return base + start; 
+}
+
+// reserve (address space only) a slot for each thread that may run frames 
+static bool reserve_arena_region( size_t capacity , int slots )
+{
+	std::lock_guard<std::mutex> lock( region_mutex ); 
+	if( region_reserved.load() )
+	{ return true; }
+	if( region_base != NULL )
+	{ return false; } // tried, and failed 
+	
+	capacity = ( capacity + arena_alignment - 1 ) & ~( arena_alignment - 1 ); 
+	void* memory = mmap( NULL , capacity * slots , PROT_READ | PROT_WRITE , MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE , -1 , 0 ); 
+	Frame_Arena* arenas = (Frame_Arena*) malloc( sizeof( Frame_Arena ) * slots ); 
+	if( memory == MAP_FAILED || arenas == NULL )
+	{
+		std::cout << "Warning: could not reserve " << slots << " frame arenas of " << capacity / 1048576 << " MB!" << std::endl; 
+		region_base = (char*) MAP_FAILED; 
+		return false; 
+	}
+	for( int k=0; k < slots ; k++ )
+	{
+		new( arenas + k ) Frame_Arena; 
+		arenas[k].base = (char*) memory + k * capacity; 
+		arenas[k].capacity = capacity; 
+		arenas[k].offset = 0; 
+		arenas[k].live.store( 0 ); 
+		arenas[k].high_water = 0; 
+	}
+	region_base = (char*) memory; 
+	region_size = (uintptr_t) capacity * slots; 
+	slot_capacity = capacity; 
+	region_slots = slots; 
+	region_arenas = arenas; 
+	region_reserved.store( true , std::memory_order_release ); 
+	return true; 
+}
+
+static Frame_Arena* create_thread_arena( size_t capacity , int slots )
+{
+	if( reserve_arena_region( capacity , slots ) == false )
+	{ return NULL; }
+	
+	// threads past the reserved slots use the heap 
+	int slot = number_of_arenas.fetch_add( 1 ); 
+	if( slot >= region_slots )
+	{
+		number_of_arenas.fetch_sub( 1 ); 
+		return NULL; 
+	}
+	return region_arenas + slot; 
+}
+
+static Frame_Arena* find_arena( const void* pointer )
+{
+	if( region_reserved.load( std::memory_order_acquire ) == false )
+	{ return NULL; }
+	uintptr_t offset = (uintptr_t) pointer - (uintptr_t) region_base; 
+	if( offset >= region_size )
+	{ return NULL; }
+	return region_arenas + offset / slot_capacity; 
+}
+
+static void* allocate( size_t size )
+{
+	if( current_arena != NULL )
+	{
+		void* pointer = current_arena->allocate( size ); 
+		if( pointer != NULL )
+		{
+			arena_allocations++; 
+			return pointer; 
+		}
+	}
+	heap_allocations++; 
+	return malloc( size > 0 ? size : 1 ); 
+}
+
+static void deallocate( void* pointer )
+{
+	if( pointer == NULL )
+	{ return; }
+	Frame_Arena* arena = find_arena( pointer ); 
+	if( arena != NULL )
+	{
+		arena->live.fetch_sub( 1 , std::memory_order_relaxed ); 
+		return; 
+	}
+	free( pointer ); 
+}
+
+void* operator new( size_t size )
+{
+	void* pointer = allocate( size ); 
+	if( pointer == NULL )
+	{ throw std::bad_alloc(); }
+	return pointer; 
+}
+
+void* operator new[]( size_t size )
+{ return operator new( size ); }
+
+void* operator new( size_t size , const std::nothrow_t& ) noexcept
+{ return allocate( size ); }
+
+void* operator new[]( size_t size , const std::nothrow_t& ) noexcept
+{ return allocate( size ); }
+
+void operator delete( void* pointer ) noexcept
+{ deallocate( pointer ); }
+
+void operator delete[]( void* pointer ) noexcept
+{ deallocate( pointer ); }
+
+void operator delete( void* pointer , const std::nothrow_t& ) noexcept
+{ deallocate( pointer ); }
+
+void operator delete[]( void* pointer , const std::nothrow_t& ) noexcept
+{ deallocate( pointer ); }
+
+Allocation_Counts thread_allocation_counts( void )
+{
+	Allocation_Counts counts; 
+	counts.heap = heap_allocations; 
+	counts.arena = arena_allocations; 
+	return counts; 
+}
+
+Frame_Arena_Scope::Frame_Arena_Scope()
+{
+	arena = NULL; 
+	start = thread_allocation_counts(); 
+	
+	// nested scopes (a frame within a frame) are part of the outer one 
+	outer = ( in_scope == false ); 
+	if( outer == false )
+	{ return; }
+	in_scope = true; 
+	
+	// (twice the threads: a team of threads may not be the last team's) 
+	if( options.frame_arena && thread_arena == NULL )
+	{ thread_arena = create_thread_arena( (size_t) options.frame_arena_size << 20 , 2 * std::max( options.threads , 1 ) ); }
+	if( options.frame_arena )
+	{ arena = thread_arena; }
+	current_arena = arena; 
+	return; 
+}
+
+Frame_Arena_Scope::~Frame_Arena_Scope()
+{
+	if( outer == false )
+	{ return; }
+	current_arena = NULL; 
+	in_scope = false; 
+	
+	total_frames++; 
+	total_heap_allocations += heap_allocations - start.heap; 
+	total_arena_allocations += arena_allocations - start.arena; 
+	
+	if( arena != NULL )
+	{
+		uint64_t high_water = arena_high_water.load(); 
+		while( arena->high_water > high_water && 
+			arena_high_water.compare_exchange_weak( high_water , arena->high_water ) == false )
+		{ }
+		int64_t live = arena->live.load(); 
+		if( live == 0 )
+		{
+			arena->offset = 0; 
+			arena_resets++; 
+		}
+		else
+		{
+			// memory that outlives its frame must come from a Heap_Allocation_Scope 
+			arenas_not_reset++; 
+			std::cout << "Warning: a frame left " << live << " allocations alive in its frame arena, " 
+				<< "so the arena was not reset (" << arena->offset / 1048576.0 << " MB in use)!" << std::endl; 
+		}
+	}
+	return; 
+}
+
+Heap_Allocation_Scope::Heap_Allocation_Scope()
+{
+	arena = current_arena; 
+	current_arena = NULL; 
+	return; 
+}
+
+Heap_Allocation_Scope::~Heap_Allocation_Scope()
+{
+	current_arena = arena; 
+	return; 
+}
+
+void display_allocation_statistics( std::ostream& os )
+{
+	uint64_t frames = total_frames.load(); 
+	if( frames == 0 )
+	{ return; }
+	
+	struct rusage usage; 
+	getrusage( RUSAGE_SELF , &usage ); 
+	
+	os << "Allocations: " << total_heap_allocations.load() << " from the heap (" 
+		<< (double) total_heap_allocations.load() / frames << " per frame), " 
+		<< total_arena_allocations.load() << " from frame arenas (" 
+		<< (double) total_arena_allocations.load() / frames << " per frame); peak RSS " 
+		<< usage.ru_maxrss / 1024.0 << " MB" << std::endl; 
+	if( options.frame_arena )
+	{
+		os << "Frame arenas: " << number_of_arenas.load() << " arenas, largest frame " 
+			<< arena_high_water.load() / 1048576.0 << " MB, " << arena_resets.load() << " resets, " 
+			<< arenas_not_reset.load() << " frames left memory alive past the frame" << std::endl; 
+	}
+	return; 
+}
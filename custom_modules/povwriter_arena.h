@@ -0,0 +1,152 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_arena_h__
+#define __povwriter_arena_h__
+
+#include <cstdint>
+#include <atomic>
+#include <iostream>
+
+#include "./povwriter.h" 
+
+// With <frame_arena>true</frame_arena>, each worker thread owns a 
+// monotonic arena: while it processes a frame, every operator new on 
+// that thread (the cell data columns, colorsets, strings, stream and 
+// file buffers, ...) is a pointer bump in the arena, and delete is a 
+// no-op. When the frame is done and nothing in the arena is still alive, 
+// the arena is reset, and the next frame reuses the same (already 
+// faulted-in) memory, so steady-state batches do no heap traffic. 
+// 
+// The arenas are slots of one range of reserved address space (a slot 
+// for each of twice <threads> threads), so operator delete on any thread 
+// tells arena memory from heap memory with one range check; memory is 
+// committed only as it is used. An allocation that does not fit, or of 
+// over 256 kB, falls back to the heap. Memory that outlives its frame 
+// (freed by another thread later, say) is counted, so the arena is only 
+// reset once it is all freed, and each frame that leaves any is warned 
+// about: what outlives a frame belongs in a Heap_Allocation_Scope. 
+// 
+// The frame tasks and the NUMA scheduler use arenas (and count each 
+// frame's allocations, with or without them); the pipeline passes frames 
+// between threads, so it does not. 
+
+class Frame_Arena
+{
+ public:
+	char* base; 
+	size_t capacity; 
+	size_t offset; // owning thread only 
+	std::atomic<int64_t> live; // allocations not yet freed (by any thread) 
+	size_t high_water; 
+	
+	void* allocate( size_t size ); // NULL if it does not fit 
+	bool contains( const void* pointer ) 
+	{ return (const char*) pointer >= base && (const char*) pointer < base + capacity; }
+}; 
+
+class Allocation_Counts
+{
+ public:
+	uint64_t heap; // operator new calls served by malloc 
+	uint64_t arena; // operator new calls served by the frame arena 
+}; 
+
+// this thread's operator new calls so far 
+Allocation_Counts thread_allocation_counts( void ); 
+
+// While a scope is alive, operator new on this thread allocates from the 
+// thread's arena (if <frame_arena> is on). When the outermost scope ends, 
+// it adds the frame's allocation counts to the totals and, if the arena 
+// is empty, resets it. 
+class Frame_Arena_Scope
+{
+ private:
+	Frame_Arena* arena; 
+	bool outer; 
+	Allocation_Counts start; 
+ public:
+	Frame_Arena_Scope(); 
+	~Frame_Arena_Scope(); 
+}; 
+
+// While a heap scope is alive, operator new on this thread uses the heap, 
+// even within a frame's arena scope: for what outlives the frame (the 
+// journal's and manifest's entries, and queued render jobs). 
+class Heap_Allocation_Scope
+{
+ private:
+	Frame_Arena* arena; 
+ public:
+	Heap_Allocation_Scope(); 
+	~Heap_Allocation_Scope(); 
+}; 
+
+// allocations per frame, arena resets, and peak RSS 
+void display_allocation_statistics( std::ostream& os ); 
+
+#endif 
@@ -0,0 +1,232 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_buffers.h" 
+#include "povwriter_journal.h" 
+
+#include <atomic>
+#include <algorithm>
+#include <climits>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+static const size_t initial_output_buffer_size = 1<<20; 
+
+static std::atomic<uint64_t> total_frames( 0 ); 
+static std::atomic<uint64_t> total_minor_faults( 0 ); 
+static std::atomic<uint64_t> total_major_faults( 0 ); 
+
+Frame_Output_Buffer::Frame_Output_Buffer()
+{
+	to_file = false; 
+	flushed = 0; 
+	reset(); 
+	return; 
+}
+
+void Frame_Output_Buffer::flush( void )
+{
+	size_t used = pptr() - pbase(); 
+	file.write( pbase() , used ); // (a failure shows in close) 
+	flushed += used; 
+	setp( memory.data() , memory.data() + std::min( memory.size() , frame_output_chunk_size ) ); 
+	return; 
+}
+
+// write out or double the memory, keeping what was written 
+Frame_Output_Buffer::int_type Frame_Output_Buffer::overflow( int_type c )
+{
+	if( traits_type::eq_int_type( c , traits_type::eof() ) )
+	{ return traits_type::not_eof( c ); }
+	
+	if( to_file && memory.size() > 0 )
+	{ flush(); }
+	else
+	{
+		size_t used = pptr() - pbase(); 
+		memory.resize( memory.size() > 0 ? 2*memory.size() : initial_output_buffer_size ); 
+		setp( memory.data() , memory.data() + memory.size() ); 
+		// pbump takes an int, and scenes can pass 2 GB 
+		for( ; used > INT_MAX ; used -= INT_MAX )
+		{ pbump( INT_MAX ); }
+		pbump( (int) used ); 
+	}
+	
+	*pptr() = traits_type::to_char_type( c ); 
+	pbump( 1 ); 
+	return c; 
+}
+
+void Frame_Output_Buffer::reset( void )
+{
+	setp( memory.data() , memory.data() + memory.size() ); 
+	flushed = 0; 
+	return; 
+}
+
+void Frame_Output_Buffer::release( void )
+{
+	std::vector<char>().swap( memory ); 
+	reset(); 
+	return; 
+}
+
+const char* Frame_Output_Buffer::data( void )
+{ return pbase(); }
+
+uint64_t Frame_Output_Buffer::size( void )
+{ return flushed + ( pptr() - pbase() ); }
+
+bool Frame_Output_Buffer::write( std::string filename )
+{
+	return write_output_file( filename , data() , size() ); 
+}
+
+bool Frame_Output_Buffer::open( std::string filename )
+{
+	reset(); 
+	if( is_stream_output( filename ) )
+	{
+		stream = filename; 
+		return true; 
+	}
+	if( memory.size() < frame_output_chunk_size )
+	{ memory.resize( frame_output_chunk_size ); }
+	setp( memory.data() , memory.data() + frame_output_chunk_size ); 
+	to_file = true; 
+	return file.open( filename ); 
+}
+
+bool Frame_Output_Buffer::close( void )
+{
+	if( stream.size() > 0 )
+	{
+		bool success = write( stream ); 
+		stream = ""; 
+		return success; 
+	}
+	if( to_file == false )
+	{ return false; }
+	flush(); 
+	to_file = false; 
+	return file.commit(); 
+}
+
+void Frame_Buffers::release( void )
+{
+	std::vector<std::vector<cell_real>>().swap( MAT ); 
+	output.release(); 
+	return; 
+}
+
+Frame_Buffers& thread_frame_buffers( void )
+{
+	static thread_local Frame_Buffers buffers; 
+	return buffers; 
+}
+
+Page_Fault_Counter::Page_Fault_Counter()
+{
+	struct rusage usage; 
+	getrusage( RUSAGE_THREAD , &usage ); 
+	minor_start = usage.ru_minflt; 
+	major_start = usage.ru_majflt; 
+	return; 
+}
+
+long Page_Fault_Counter::minor( void )
+{
+	struct rusage usage; 
+	getrusage( RUSAGE_THREAD , &usage ); 
+	return usage.ru_minflt - minor_start; 
+}
+
+long Page_Fault_Counter::major( void )
+{
+	struct rusage usage; 
+	getrusage( RUSAGE_THREAD , &usage ); 
+	return usage.ru_majflt - major_start; 
+}
+
+void Page_Fault_Counter::record( void )
+{
+	total_frames++; 
+	total_minor_faults += minor(); 
+	total_major_faults += major(); 
+	return; 
+}
+
+void display_page_fault_statistics( std::ostream& os )
+{
+	uint64_t frames = total_frames.load(); 
+	if( frames == 0 )
+	{ return; }
+	os << "Page faults: " << total_minor_faults.load() << " minor (" << (double) total_minor_faults.load() / frames 
+		<< " per frame), " << total_major_faults.load() << " major (" << (double) total_major_faults.load() / frames 
+		<< " per frame)" << std::endl; 
+	return; 
+}
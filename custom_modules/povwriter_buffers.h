@@ -0,0 +1,152 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_buffers_h__
+#define __povwriter_buffers_h__
+
+#include <vector>
+#include <streambuf>
+#include <cstdint>
+
+#include "./povwriter.h" 
+#include "./povwriter_journal.h" 
+
+// Each worker thread keeps its cell data and its output buffer from one 
+// frame to the next, and only grows them when a frame is larger than any 
+// before. Runs usually grow over time, so after the first few frames the 
+// buffers are already faulted in, rather than freshly allocated (and page 
+// faulted) for every frame. 
+
+// bytes of an opened frame's text written to its file at a time 
+static const size_t frame_output_chunk_size = 1<<22; 
+
+// an ostream buffer over memory that is kept between frames. After open(), 
+// the text goes to the (temporary) file in fixed-size pieces as the memory 
+// fills, so a scene of any size needs only a few MB; close() renames it 
+// into place. (Streams, and text gathered after reset(), are held whole.) 
+class Frame_Output_Buffer : public std::streambuf
+{
+ private:
+	std::vector<char> memory; 
+	Atomic_Output_File file; 
+	bool to_file; 
+	std::string stream; // a stream output, written whole by close() 
+	uint64_t flushed; // bytes already in the file 
+	
+	void flush( void ); 
+ protected:
+	int_type overflow( int_type c ); 
+ public:
+	Frame_Output_Buffer(); 
+	
+	void reset( void ); // empty, keeping the memory (text is held whole) 
+	void release( void ); // empty, freeing the memory 
+	
+	// the text since reset() 
+	const char* data( void ); 
+	// bytes since reset() or open() (including those already in the file) 
+	uint64_t size( void ); 
+	
+	// write the text since reset() 
+	bool write( std::string filename ); 
+	
+	// write the text from here to close() to filename 
+	bool open( std::string filename ); 
+	bool close( void ); // false if the file could not be written 
+}; 
+
+class Frame_Buffers
+{
+ public:
+	std::vector<std::vector<cell_real>> MAT; 
+	Frame_Output_Buffer output; 
+	
+	void release( void ); 
+}; 
+
+// the calling thread's buffers 
+Frame_Buffers& thread_frame_buffers( void ); 
+
+// page faults of the calling thread since construction (the instrumentation 
+// for buffer reuse) 
+class Page_Fault_Counter
+{
+ private:
+	long minor_start; 
+	long major_start; 
+ public:
+	Page_Fault_Counter(); 
+	long minor( void ); 
+	long major( void ); 
+	
+	// add this frame's faults to the run's totals 
+	void record( void ); 
+}; 
+
+void display_page_fault_statistics( std::ostream& os ); 
+
+#endif 
@@ -0,0 +1,319 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_cache.h" 
+
+#include <cfloat>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char render_cache_magic[8] = {'P','O','V','C','A','C','H','E'}; 
+static const uint32_t render_cache_version = 1; 
+
+// column data start at a 64-byte boundary after the column table 
+
+static uint64_t render_cache_data_offset( uint32_t number_of_columns )
+{
+	uint64_t offset = sizeof(Render_Cache_Header) + number_of_columns * sizeof(Render_Cache_Column); 
+	return ( offset + 63 ) & ~( (uint64_t) 63 ); 
+}
+
+std::string render_cache_filename( std::string source_filename )
+{
+	if( options.render_cache_folder.size() == 0 )
+	{ return source_filename + ".povcache"; }
+	
+	// keep only the file name, and place it in the cache folder 
+	std::string base = source_filename; 
+	size_t slash = base.find_last_of( '/' ); 
+	if( slash != std::string::npos )
+	{ base = base.substr( slash+1 ); }
+	return options.render_cache_folder + "/" + base + ".povcache"; 
+}
+
+// the columns a cache of a source with the given rows holds: those of 
+// render_cache_columns that exist in the source, and always row 0 (cell 
+// ID), since the render path counts cells with MAT[0].size() 
+
+static std::vector<uint32_t> cached_columns( uint64_t rows )
+{
+	std::vector<int> indices = options.render_cache_columns; 
+	if( std::find( indices.begin() , indices.end() , 0 ) == indices.end() )
+	{ indices.insert( indices.begin() , 0 ); }
+	
+	std::vector<uint32_t> columns; 
+	for( unsigned int k=0; k < indices.size() ; k++ )
+	{
+		if( indices[k] >= 0 && (uint64_t) indices[k] < rows && 
+			std::find( columns.begin() , columns.end() , (uint32_t) indices[k] ) == columns.end() )
+		{ columns.push_back( indices[k] ); }
+	}
+	return columns; 
+}
+
+static bool map_render_cache( std::string source_filename , void** map , size_t* map_size )
+{
+	struct stat source_info; 
+	if( stat( source_filename.c_str() , &source_info ) != 0 )
+	{ return false; }
+	
+	std::string filename = render_cache_filename( source_filename ); 
+	int fd = open( filename.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{ return false; }
+	
+	struct stat info; 
+	if( fstat( fd , &info ) != 0 || info.st_size < (off_t) sizeof(Render_Cache_Header) )
+	{
+		close( fd ); 
+		return false; 
+	}
+	
+	*map_size = info.st_size; 
+	*map = mmap( NULL , *map_size , PROT_READ , MAP_PRIVATE , fd , 0 ); 
+	close( fd ); 
+	if( *map == MAP_FAILED )
+	{ return false; }
+	
+	// check the header against the source file 
+	
+	Render_Cache_Header* header = (Render_Cache_Header*) *map; 
+	bool valid = true; 
+	if( memcmp( header->magic , render_cache_magic , 8 ) != 0 || 
+		header->version != render_cache_version || 
+		header->source_size != (uint64_t) source_info.st_size || 
+		header->source_mtime != (int64_t) source_info.st_mtime )
+	{ valid = false; }
+	
+	if( valid && *map_size < render_cache_data_offset( header->number_of_columns ) 
+		+ header->number_of_columns * header->cells * sizeof(float) )
+	{ valid = false; }
+	
+	// a cache built with other render_cache_columns is stale: the coloring 
+	// function may read rows it does not hold 
+	
+	if( valid )
+	{
+		Render_Cache_Column* columns = (Render_Cache_Column*) ( (char*) *map + sizeof(Render_Cache_Header) ); 
+		std::vector<uint32_t> cached; 
+		for( unsigned int k=0; k < header->number_of_columns ; k++ )
+		{
+			if( columns[k].index >= header->rows )
+			{ valid = false; }
+			cached.push_back( columns[k].index ); 
+		}
+		std::vector<uint32_t> wanted = cached_columns( header->rows ); 
+		std::sort( cached.begin() , cached.end() ); 
+		std::sort( wanted.begin() , wanted.end() ); 
+		if( cached != wanted )
+		{ valid = false; }
+	}
+	
+	if( valid == false )
+	{
+		munmap( *map , *map_size ); 
+		return false; 
+	}
+	return true; 
+}
+
+bool render_cache_is_valid( std::string source_filename )
+{
+	void* map; 
+	size_t map_size; 
+	if( map_render_cache( source_filename , &map , &map_size ) == false )
+	{ return false; }
+	munmap( map , map_size ); 
+	return true; 
+}
+
+bool read_render_cache( std::string source_filename , std::vector<std::vector<cell_real>>& MAT )
+{
+	void* map; 
+	size_t map_size; 
+	if( map_render_cache( source_filename , &map , &map_size ) == false )
+	{ return false; }
+	madvise( map , map_size , MADV_SEQUENTIAL ); 
+	
+	Render_Cache_Header* header = (Render_Cache_Header*) map; 
+	Render_Cache_Column* columns = (Render_Cache_Column*) ( (char*) map + sizeof(Render_Cache_Header) ); 
+	const float* data = (const float*) ( (char*) map + render_cache_data_offset( header->number_of_columns ) ); 
+	
+	MAT.resize( header->rows ); 
+	for( unsigned int k=0; k < MAT.size(); k++ )
+	{ MAT[k].clear(); }
+	
+	for( unsigned int k=0; k < header->number_of_columns ; k++ )
+	{
+		std::vector<cell_real>& row = MAT[ columns[k].index ]; 
+		const float* column = data + k*header->cells; 
+		row.assign( column , column + header->cells ); 
+	}
+	
+	munmap( map , map_size ); 
+	return true; 
+}
+
+bool write_render_cache( std::string source_filename , std::vector<std::vector<cell_real>>& MAT )
+{
+	struct stat source_info; 
+	if( stat( source_filename.c_str() , &source_info ) != 0 || MAT.size() == 0 )
+	{ return false; }
+	
+	Render_Cache_Header header; 
+	memset( &header , 0 , sizeof(Render_Cache_Header) ); 
+	memcpy( header.magic , render_cache_magic , 8 ); 
+	header.version = render_cache_version; 
+	header.rows = MAT.size(); 
+	header.cells = MAT[0].size(); 
+	header.source_size = source_info.st_size; 
+	header.source_mtime = source_info.st_mtime; 
+	
+	// only keep the columns that exist in this file 
+	
+	std::vector<uint32_t> indices = cached_columns( MAT.size() ); 
+	std::vector<Render_Cache_Column> columns; 
+	for( unsigned int k=0; k < indices.size() ; k++ )
+	{
+		Render_Cache_Column column; 
+		column.index = indices[k]; 
+		column.min = FLT_MAX; 
+		column.max = -FLT_MAX; 
+		for( uint64_t i=0; i < header.cells ; i++ )
+		{
+			float value = (float) MAT[column.index][i]; 
+			if( value < column.min )
+			{ column.min = value; }
+			if( value > column.max )
+			{ column.max = value; }
+		}
+		columns.push_back( column ); 
+	}
+	header.number_of_columns = columns.size(); 
+	
+	// bounds of the cell centers (rows 1, 2, 3)
+	
+	for( int d=0; d < 3 ; d++ )
+	{
+		header.bounds[d] = FLT_MAX; 
+		header.bounds[d+3] = -FLT_MAX; 
+		for( unsigned int k=0; k < columns.size() ; k++ )
+		{
+			if( columns[k].index == (uint32_t) d+1 )
+			{
+				header.bounds[d] = columns[k].min; 
+				header.bounds[d+3] = columns[k].max; 
+			}
+		}
+	}
+	
+	// write to a temporary file, then rename it into place, so a 
+	// concurrent reader never sees a partial cache 
+	
+	std::string filename = render_cache_filename( source_filename ); 
+	char suffix [64]; 
+	sprintf( suffix , ".tmp%i" , (int) getpid() ); 
+	std::string temp_filename = filename + suffix; 
+	
+	FILE* fp = fopen( temp_filename.c_str() , "wb" ); 
+	if( fp == NULL )
+	{
+		std::cout << "Warning: could not write render cache " << temp_filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	bool success = true; 
+	success &= fwrite( &header , sizeof(Render_Cache_Header) , 1 , fp ) == 1; 
+	if( columns.size() > 0 )
+	{ success &= fwrite( columns.data() , sizeof(Render_Cache_Column) , columns.size() , fp ) == columns.size(); }
+	
+	uint64_t offset = sizeof(Render_Cache_Header) + columns.size() * sizeof(Render_Cache_Column); 
+	std::vector<char> padding( render_cache_data_offset( columns.size() ) - offset , 0 ); 
+	if( padding.size() > 0 )
+	{ success &= fwrite( padding.data() , 1 , padding.size() , fp ) == padding.size(); }
+	
+	std::vector<float> column( header.cells ); 
+	for( unsigned int k=0; k < columns.size() && success ; k++ )
+	{
+		for( uint64_t i=0; i < header.cells ; i++ )
+		{ column[i] = (float) MAT[ columns[k].index ][i]; }
+		success &= fwrite( column.data() , sizeof(float) , header.cells , fp ) == header.cells; 
+	}
+	success &= fclose( fp ) == 0; 
+	
+	if( success == false || rename( temp_filename.c_str() , filename.c_str() ) != 0 )
+	{
+		std::cout << "Warning: could not write render cache " << filename << "!" << std::endl; 
+		remove( temp_filename.c_str() ); 
+		return false; 
+	}
+	return true; 
+}
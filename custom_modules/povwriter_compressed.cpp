@@ -0,0 +1,529 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_compressed.h" 
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+
+#ifdef POVWRITER_ZLIB
+#include <zlib.h>
+#endif 
+
+#ifdef POVWRITER_ZSTD
+#include <zstd.h>
+#endif 
+
+static const size_t compressed_chunk_size = 1<<20; 
+
+Matlab_Stream_Decoder::Matlab_Stream_Decoder( std::vector<std::vector<cell_real>>& output )
+{
+	MAT = &output; 
+	header_done = false; 
+	failed = false; 
+	rows = 0; 
+	cols = 0; 
+	type_data_format = 0; 
+	column_size = 0; 
+	next_column = 0; 
+	return; 
+}
+
+// the same 20-byte header (and name) as read_matlab_header 
+
+bool Matlab_Stream_Decoder::read_header( void )
+{
+	if( pending.size() < 20 )
+	{ return false; }
+	
+	unsigned int header[5]; 
+	memcpy( header , pending.data() , 20 ); 
+	if( pending.size() < 20 + (uint64_t) header[4] )
+	{ return false; }
+	
+	unsigned int type = header[0]; 
+	type_data_format = tens( type ); 
+	if( thousands( type ) != 0 || hundreds( type ) != 0 || type_data_format > 5 || ones( type ) != 0 || header[3] != 0 )
+	{
+		std::cout << "Error: I can't read this format yet!" << std::endl; 
+		failed = true; 
+		return false; 
+	}
+	
+	rows = header[1]; 
+	cols = header[2]; 
+	column_size = (uint64_t) rows * matlab_entry_size( type_data_format ); 
+	
+	resize_matlab_output( *MAT , rows , cols ); 
+	
+	pending.erase( pending.begin() , pending.begin() + 20 + header[4] ); 
+	header_done = true; 
+	return true; 
+}
+
+bool Matlab_Stream_Decoder::add( const char* data , size_t size )
+{
+	if( failed )
+	{ return false; }
+	
+	// until the header is complete, collect everything 
+	
+	std::vector<char> chunk; 
+	if( header_done == false )
+	{
+		pending.insert( pending.end() , data , data + size ); 
+		if( read_header() == false )
+		{ return failed == false; }
+		chunk.swap( pending ); 
+		data = chunk.data(); 
+		size = chunk.size(); 
+	}
+	if( column_size == 0 )
+	{ return true; }
+	
+	// complete the partial column left by the last chunk 
+	
+	if( pending.size() > 0 )
+	{
+		size_t needed = column_size - pending.size(); 
+		if( needed > size )
+		{ needed = size; }
+		pending.insert( pending.end() , data , data + needed ); 
+		data += needed; 
+		size -= needed; 
+		if( pending.size() < column_size )
+		{ return true; }
+		if( next_column < cols )
+		{
+			decode_matlab_columns( pending.data() , type_data_format , rows , next_column , 1 , *MAT ); 
+			next_column++; 
+		}
+		pending.clear(); 
+	}
+	
+	// decode every whole column in place, and keep the partial one 
+	
+	uint64_t ncols = size / column_size; 
+	if( next_column + ncols > cols )
+	{ ncols = cols - next_column; }
+	if( ncols > 0 )
+	{
+		decode_matlab_columns( data , type_data_format , rows , next_column , ncols , *MAT ); 
+		next_column += ncols; 
+	}
+	data += ncols*column_size; 
+	size -= ncols*column_size; 
+	if( next_column < cols )
+	{ pending.assign( data , data + size ); }
+	return true; 
+}
+
+bool Matlab_Stream_Decoder::complete( void )
+{ return failed == false && header_done && next_column == cols; }
+
+Snapshot_Compression snapshot_compression( std::string filename )
+{
+	unsigned char magic[4] = {0,0,0,0}; 
+	FILE* fp = fopen( filename.c_str() , "rb" ); 
+	if( fp == NULL )
+	{ return compression_none; }
+	size_t result = fread( magic , 1 , 4 , fp ); 
+	fclose( fp ); 
+	
+	if( result >= 2 && magic[0] == 0x1f && magic[1] == 0x8b )
+	{ return compression_gzip; }
+	if( result == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd )
+	{ return compression_zstd; }
+	return compression_none; 
+}
+
+std::string find_snapshot_file( std::string filename )
+{
+	struct stat info; 
+	if( stat( filename.c_str() , &info ) == 0 )
+	{ return filename; }
+	
+	std::string suffixes [2] = { ".gz" , ".zst" }; 
+	for( int k=0; k < 2 ; k++ )
+	{
+		if( stat( ( filename + suffixes[k] ).c_str() , &info ) == 0 )
+		{ return filename + suffixes[k]; }
+	}
+	return filename; 
+}
+
+#ifdef POVWRITER_ZLIB
+static bool read_gzip_matlab( std::string filename , Matlab_Stream_Decoder& decoder )
+{
+	FILE* fp = fopen( filename.c_str() , "rb" ); 
+	if( fp == NULL )
+	{ return false; }
+	
+	z_stream stream; 
+	memset( &stream , 0 , sizeof(z_stream) ); 
+	if( inflateInit2( &stream , 15+32 ) != Z_OK ) // 32: detect gzip or zlib headers 
+	{
+		fclose( fp ); 
+		return false; 
+	}
+	
+	std::vector<char> in( compressed_chunk_size ); 
+	std::vector<char> out( 4*compressed_chunk_size ); 
+	int status = Z_OK; 
+	bool ended = false; 
+	bool success = true; 
+	
+	while( success )
+	{
+		stream.avail_in = fread( in.data() , 1 , in.size() , fp ); 
+		stream.next_in = (Bytef*) in.data(); 
+		if( stream.avail_in == 0 )
+		{ break; }
+		
+		// inflate until it has used all of this input and has no output 
+		// left to give (a full out buffer may leave some in the stream) 
+		do
+		{
+			// concatenated gzip members (e.g., from pigz or bgzip) 
+			if( ended )
+			{
+				inflateReset( &stream ); 
+				ended = false; 
+			}
+			
+			stream.avail_out = out.size(); 
+			stream.next_out = (Bytef*) out.data(); 
+			status = inflate( &stream , Z_NO_FLUSH ); 
+			if( status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR )
+			{
+				std::cout << "Error: could not decompress " << filename << "!" << std::endl; 
+				success = false; 
+				break; 
+			}
+			success = decoder.add( out.data() , out.size() - stream.avail_out ); 
+			
+			if( status == Z_STREAM_END )
+			{ ended = true; }
+		}
+		while( success && ( ( ended == false && stream.avail_out == 0 ) || ( ended && stream.avail_in > 0 ) ) ); 
+	}
+	
+	if( success && ( ferror( fp ) || ended == false ) )
+	{
+		std::cout << "Error: " << filename << " ends in the middle of a gzip stream!" << std::endl; 
+		success = false; 
+	}
+	
+	inflateEnd( &stream ); 
+	fclose( fp ); 
+	return success; 
+}
+#endif 
+
+#ifdef POVWRITER_ZSTD
+static bool read_zstd_matlab_streaming( std::string filename , Matlab_Stream_Decoder& decoder )
+{
+	FILE* fp = fopen( filename.c_str() , "rb" ); 
+	if( fp == NULL )
+	{ return false; }
+	
+	ZSTD_DStream* stream = ZSTD_createDStream(); 
+	ZSTD_initDStream( stream ); 
+	
+	std::vector<char> in( ZSTD_DStreamInSize() ); 
+	std::vector<char> out( ZSTD_DStreamOutSize() ); 
+	bool success = true; 
+	size_t result = 0; // 0 once a frame is complete 
+	
+	size_t count; 
+	while( success && ( count = fread( in.data() , 1 , in.size() , fp ) ) > 0 )
+	{
+		// decompress until all of this input is used and the output 
+		// buffer is not filled (a full one may leave some in the stream) 
+		ZSTD_inBuffer input = { in.data() , count , 0 }; 
+		ZSTD_outBuffer output = { out.data() , out.size() , out.size() }; 
+		while( success && ( input.pos < input.size || output.pos == output.size ) )
+		{
+			output.pos = 0; 
+			result = ZSTD_decompressStream( stream , &output , &input ); 
+			if( ZSTD_isError( result ) )
+			{
+				std::cout << "Error: could not decompress " << filename << ": " << ZSTD_getErrorName( result ) << std::endl; 
+				success = false; 
+				break; 
+			}
+			success = decoder.add( out.data() , output.pos ); 
+		}
+	}
+	
+	if( success && ( ferror( fp ) || result != 0 ) )
+	{
+		std::cout << "Error: " << filename << " ends in the middle of a zstd frame!" << std::endl; 
+		success = false; 
+	}
+	
+	ZSTD_freeDStream( stream ); 
+	fclose( fp ); 
+	return success; 
+}
+
+static bool decompress_zstd_frames( const char* map , std::vector<size_t>& in_offsets , std::vector<size_t>& in_sizes , 
+	std::vector<size_t>& out_offsets , std::vector<char>& buffer )
+{
+	bool success = true; 
+	#pragma omp taskloop grainsize( 1 ) shared( success , in_offsets , in_sizes , out_offsets , buffer )
+	for( int k=0; k < (int) in_offsets.size() ; k++ )
+	{
+		size_t result = ZSTD_decompress( buffer.data() + out_offsets[k] , out_offsets[k+1] - out_offsets[k] , 
+			map + in_offsets[k] , in_sizes[k] ); 
+		if( ZSTD_isError( result ) )
+		{
+			#pragma omp atomic write
+			success = false; 
+		}
+	}
+	return success; 
+}
+
+// Independent zstd frames with known sizes can be decompressed in 
+// parallel, each into its own part of the decompressed matrix. Returns 
+// false (without output) if the file is a single frame. 
+
+static bool read_zstd_matlab_parallel( std::string filename , std::vector<std::vector<cell_real>>& MAT , 
+	int number_of_threads , bool* attempted )
+{
+	*attempted = false; 
+	int fd = open( filename.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{ return false; }
+	struct stat info; 
+	if( fstat( fd , &info ) != 0 || info.st_size == 0 )
+	{
+		close( fd ); 
+		return false; 
+	}
+	size_t size = info.st_size; 
+	char* map = (char*) mmap( NULL , size , PROT_READ , MAP_PRIVATE , fd , 0 ); 
+	close( fd ); 
+	if( map == MAP_FAILED )
+	{ return false; }
+	
+	// find the frames, and where each one's output goes 
+	
+	std::vector<size_t> in_offsets; 
+	std::vector<size_t> in_sizes; 
+	std::vector<size_t> out_offsets; 
+	size_t in_offset = 0; 
+	size_t out_size = 0; 
+	bool sizes_known = true; 
+	while( in_offset < size && sizes_known )
+	{
+		size_t frame_size = ZSTD_findFrameCompressedSize( map + in_offset , size - in_offset ); 
+		unsigned long long content_size = ZSTD_getFrameContentSize( map + in_offset , size - in_offset ); 
+		if( ZSTD_isError( frame_size ) || content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR )
+		{
+			sizes_known = false; 
+			break; 
+		}
+		in_offsets.push_back( in_offset ); 
+		in_sizes.push_back( frame_size ); 
+		out_offsets.push_back( out_size ); 
+		in_offset += frame_size; 
+		out_size += content_size; 
+	}
+	
+	if( sizes_known == false || in_offsets.size() < 2 )
+	{
+		munmap( map , size ); 
+		return false; 
+	}
+	*attempted = true; 
+	out_offsets.push_back( out_size ); 
+	
+	std::vector<char> buffer( out_size ); 
+	bool success = true; 
+	
+	// one task per frame, in the current team if there is one 
+	
+	if( omp_in_parallel() )
+	{ success = decompress_zstd_frames( map , in_offsets , in_sizes , out_offsets , buffer ); }
+	else
+	{
+		#pragma omp parallel num_threads( number_of_threads )
+		#pragma omp single
+		success = decompress_zstd_frames( map , in_offsets , in_sizes , out_offsets , buffer ); 
+	}
+	munmap( map , size ); 
+	
+	if( success == false )
+	{
+		std::cout << "Error: could not decompress " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	Matlab_Stream_Decoder decoder( MAT ); 
+	return decoder.add( buffer.data() , buffer.size() ) && decoder.complete(); 
+}
+#endif 
+
+bool read_compressed_matlab( std::string filename , std::vector<std::vector<cell_real>>& MAT , int number_of_threads )
+{
+	Snapshot_Compression compression = snapshot_compression( filename ); 
+	Matlab_Stream_Decoder decoder( MAT ); 
+	bool success = false; 
+	
+	if( compression == compression_gzip )
+	{
+		#ifdef POVWRITER_ZLIB
+		success = read_gzip_matlab( filename , decoder ); 
+		#else
+		std::cout << "Error: " << filename << " is gzip-compressed; rebuild with make ZLIB=1 to read it!" << std::endl; 
+		return false; 
+		#endif 
+	}
+	
+	if( compression == compression_zstd )
+	{
+		#ifdef POVWRITER_ZSTD
+		bool attempted = false; 
+		if( number_of_threads > 1 ) 
+		{
+			success = read_zstd_matlab_parallel( filename , MAT , number_of_threads , &attempted ); 
+			if( attempted )
+			{ return success; }
+		}
+		success = read_zstd_matlab_streaming( filename , decoder ); 
+		#else
+		std::cout << "Error: " << filename << " is zstd-compressed; rebuild with make ZSTD=1 to read it!" << std::endl; 
+		return false; 
+		#endif 
+	}
+	
+	if( success && decoder.complete() == false )
+	{
+		std::cout << "Error: " << filename << " ended before the end of the matrix!" << std::endl; 
+		success = false; 
+	}
+	return success; 
+}
+
+bool read_compressed_matlab_dimensions( std::string filename , uint64_t* rows , uint64_t* cells )
+{
+	#if defined(POVWRITER_ZLIB) || defined(POVWRITER_ZSTD)
+	Snapshot_Compression compression = snapshot_compression( filename ); 
+	#endif 
+	unsigned int header[5]; 
+	size_t done = 0; 
+	
+	#ifdef POVWRITER_ZLIB
+	if( compression == compression_gzip )
+	{
+		gzFile file = gzopen( filename.c_str() , "rb" ); 
+		if( file == NULL )
+		{ return false; }
+		int count = gzread( file , header , 20 ); 
+		gzclose( file ); 
+		done = count > 0 ? count : 0; 
+	}
+	#endif 
+	
+	#ifdef POVWRITER_ZSTD
+	if( compression == compression_zstd )
+	{
+		FILE* fp = fopen( filename.c_str() , "rb" ); 
+		if( fp == NULL )
+		{ return false; }
+		ZSTD_DStream* stream = ZSTD_createDStream(); 
+		ZSTD_initDStream( stream ); 
+		
+		// small reads: only the first few bytes are needed 
+		std::vector<char> in( 4096 ); 
+		ZSTD_outBuffer output = { header , 20 , 0 }; 
+		size_t count; 
+		bool failed = false; 
+		while( failed == false && output.pos < output.size && ( count = fread( in.data() , 1 , in.size() , fp ) ) > 0 )
+		{
+			ZSTD_inBuffer input = { in.data() , count , 0 }; 
+			while( failed == false && input.pos < input.size && output.pos < output.size )
+			{ failed = ZSTD_isError( ZSTD_decompressStream( stream , &output , &input ) ); }
+		}
+		done = output.pos; 
+		ZSTD_freeDStream( stream ); 
+		fclose( fp ); 
+	}
+	#endif 
+	
+	if( done < 20 )
+	{ return false; }
+	*rows = header[1]; 
+	*cells = header[2]; 
+	return true; 
+}
@@ -0,0 +1,120 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_compressed_h__
+#define __povwriter_compressed_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./povwriter.h" 
+
+// Snapshots can be read from gzip (build with "make ZLIB=1") or zstd 
+// (build with "make ZSTD=1") compressed files, e.g., FILE.mat.gz or 
+// FILE.mat.zst. They are decompressed chunk by chunk and decoded straight 
+// into the cell data, without a decompressed copy on disk. zstd files with 
+// several independent frames (e.g., from pzstd) are decompressed by 
+// several threads at once. 
+
+// decodes a MATLAB v4 matrix as its bytes arrive 
+class Matlab_Stream_Decoder
+{
+ private:
+	std::vector<char> pending; // bytes not decoded yet 
+	bool header_done; 
+	unsigned int rows; 
+	unsigned int cols; 
+	unsigned int type_data_format; 
+	uint64_t column_size; 
+	uint64_t next_column; 
+	std::vector<std::vector<cell_real>>* MAT; 
+	
+	bool read_header( void ); 
+ public:
+	bool failed; 
+	
+	Matlab_Stream_Decoder( std::vector<std::vector<cell_real>>& output ); 
+	
+	bool add( const char* data , size_t size ); 
+	bool complete( void ); 
+}; 
+
+enum Snapshot_Compression{ compression_none = 0 , compression_gzip = 1 , compression_zstd = 2 }; 
+
+// detect the format from the first bytes of the file 
+Snapshot_Compression snapshot_compression( std::string filename ); 
+
+// filename, or filename.gz or filename.zst if only those exist 
+std::string find_snapshot_file( std::string filename ); 
+
+bool read_compressed_matlab( std::string filename , std::vector<std::vector<cell_real>>& MAT , int number_of_threads ); 
+
+// matrix size, from decompressing just the MATLAB header 
+bool read_compressed_matlab_dimensions( std::string filename , uint64_t* rows , uint64_t* cells ); 
+
+#endif 
@@ -0,0 +1,179 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_insitu.h" 
+#include "povwriter_pipeline.h" 
+#include "povwriter_buffers.h" 
+
+#include <thread>
+#include <memory>
+#include <omp.h>
+
+static const int cell_matrix_rows = 33; 
+
+struct In_Situ_Frame
+{
+	int index; 
+	std::vector<std::vector<cell_real>> MAT; 
+}; 
+
+static std::unique_ptr< Bounded_Queue<In_Situ_Frame> > in_situ_queue; 
+static std::thread render_thread; 
+
+POV_Frame_Columns::POV_Frame_Columns( int cells_in )
+{
+	cells = cells_in; 
+	values.assign( cell_matrix_rows , (const double*) NULL ); 
+	strides.assign( cell_matrix_rows , 1 ); 
+	return; 
+}
+
+void POV_Frame_Columns::set_column( int row , const double* values_in , int stride )
+{
+	if( row >= (int) values.size() )
+	{
+		values.resize( row+1 , (const double*) NULL ); 
+		strides.resize( row+1 , 1 ); 
+	}
+	values[row] = values_in; 
+	strides[row] = stride; 
+	return; 
+}
+
+static void render_queued_frames( void )
+{
+	omp_set_num_threads( options.threads ); 
+	Frame_Output_Buffer output; 
+	In_Situ_Frame frame; 
+	double waited; 
+	while( in_situ_queue->pop( frame , &waited ) )
+	{
+		std::string filename = create_output_filename( frame.index ); 
+		output.open( filename ); 
+		std::ostream os( &output ); 
+		#pragma omp parallel 
+		#pragma omp single 
+		write_frame( os , frame.MAT ); 
+		
+		if( output.close() == false )
+		{ std::cout << "Error: could not write " << filename << "!" << std::endl; }
+	}
+	return; 
+}
+
+bool povwriter_start( std::string config_file )
+{
+	if( load_config_file( config_file ) == false )
+	{ return false; }
+	// every frame needs a file of its own 
+	if( is_stream_output( options.output ) == false && output_index_fields( options.output ) != 1 )
+	{
+		std::cout << "Error: output " << options.output << " needs one %d or %i field for the frame index!" << std::endl; 
+		return false; 
+	}
+	setup_POV_camera(); 
+	
+	in_situ_queue.reset( new Bounded_Queue<In_Situ_Frame>( options.pipeline_queue > 0 ? options.pipeline_queue : 1 ) ); 
+	render_thread = std::thread( render_queued_frames ); 
+	return true; 
+}
+
+bool povwriter_render_frame( int index , POV_Frame_Columns& columns )
+{
+	if( !in_situ_queue )
+	{ return false; }
+	
+	In_Situ_Frame frame; 
+	frame.index = index; 
+	frame.MAT.resize( columns.values.size() ); 
+	for( unsigned int row=0 ; row < columns.values.size() ; row++ )
+	{
+		std::vector<cell_real>& destination = frame.MAT[row]; 
+		destination.resize( columns.cells ); 
+		const double* source = columns.values[row]; 
+		int stride = columns.strides[row]; 
+		if( source == NULL )
+		{
+			std::fill( destination.begin() , destination.end() , (cell_real) 0 ); 
+			continue; 
+		}
+		for( int i=0 ; i < columns.cells ; i++ )
+		{ destination[i] = (cell_real) source[ stride*i ]; }
+	}
+	in_situ_queue->push( frame ); 
+	return true; 
+}
+
+void povwriter_finish( void )
+{
+	if( !in_situ_queue )
+	{ return; }
+	in_situ_queue->close(); 
+	render_thread.join(); 
+	in_situ_queue.reset(); 
+	return; 
+}
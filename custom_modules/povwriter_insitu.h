@@ -0,0 +1,131 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_insitu_h__
+#define __povwriter_insitu_h__
+
+#include <string>
+#include <vector>
+
+#include "./povwriter.h" 
+
+// In-situ rendering: a simulation linked with libpovwriter.a ("make 
+// libpovwriter.a") hands each frame's cell data straight from its memory 
+// as columns, and the frame is rendered and written on a background 
+// thread, with no .mat file to write and read back. 
+// 
+//   povwriter_start( "./config/povwriter-settings.xml" ); 
+//   ... 
+//   POV_Frame_Columns columns( n ); 
+//   columns.set_column( 0 , IDs ); 
+//   columns.set_column( 1 , &positions[0] , 3 ); // x of interleaved x,y,z 
+//   columns.set_column( 2 , &positions[1] , 3 ); 
+//   ... 
+//   povwriter_render_frame( index , columns ); // writes povNNNNNNNN.pov 
+//   ... 
+//   povwriter_finish(); 
+// 
+// Rows are those of PhysiCell's cell matrix (0: ID, 1-3: position, 4: 
+// total volume, 5: type, 6: cycle model, 7: current phase, 9: nuclear 
+// volume, ...); rows that are not set are zero. The columns are copied 
+// when the frame is queued, so the simulation may change them as soon as 
+// povwriter_render_frame returns. It blocks only while <pipeline queue> 
+// (at least 1) frames already wait for the render thread, which renders 
+// with <threads> threads. 
+// 
+// The library leaves out povwriter_arena.o, so it does not replace the 
+// simulation's operator new. Its only global symbols are those marked 
+// POVWRITER_API: povwriter's own copies of BioFVM, pugixml, and the 
+// PhysiCell modules are local to it, so they do not clash with the 
+// simulation's. Link with -fopenmp (and the compression and NUMA 
+// libraries, if built with them). 
+
+#define POVWRITER_API __attribute__(( visibility( "default" ) ))
+
+class POVWRITER_API POV_Frame_Columns
+{
+ public:
+	int cells; 
+	std::vector<const double*> values; // by row; NULL: zeros 
+	std::vector<int> strides; 
+	
+	POV_Frame_Columns( int cells ); 
+	
+	// values[ stride*i ] is row's value for cell i 
+	void set_column( int row , const double* values , int stride = 1 ); 
+}; 
+
+// load the settings and start the render thread 
+POVWRITER_API bool povwriter_start( std::string config_file ); 
+
+// copy the columns and queue the frame with this (time) index 
+POVWRITER_API bool povwriter_render_frame( int index , POV_Frame_Columns& columns ); 
+
+// render the queued frames and stop the render thread 
+POVWRITER_API void povwriter_finish( void ); 
+
+#endif 
@@ -0,0 +1,287 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_journal.h" 
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omp.h>
+
+Frame_Journal frame_journal; 
+
+static const double journal_sync_interval = 1.0; // seconds 
+
+static bool write_all( int fd , const char* data , size_t size )
+{
+	while( size > 0 )
+	{
+		ssize_t result = write( fd , data , size ); 
+		if( result < 0 && errno == EINTR )
+		{ continue; }
+		if( result <= 0 )
+		{ return false; }
+		data += result; 
+		size -= result; 
+	}
+	return true; 
+}
+
+static std::string directory_of( std::string filename )
+{
+	size_t slash = filename.find_last_of( '/' ); 
+	if( slash == std::string::npos )
+	{ return "."; }
+	if( slash == 0 )
+	{ return "/"; }
+	return filename.substr( 0 , slash ); 
+}
+
+static void sync_directory( std::string directory )
+{
+	int fd = open( directory.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{ return; }
+	fsync( fd ); 
+	close( fd ); 
+	return; 
+}
+
+Atomic_Output_File::Atomic_Output_File()
+{
+	fd = -1; 
+	failed = false; 
+	return; 
+}
+
+bool Atomic_Output_File::open( std::string filename_in )
+{
+	filename = filename_in; 
+	std::vector<char> name( filename.begin() , filename.end() ); 
+	const char suffix [] = ".tmp.XXXXXX"; 
+	name.insert( name.end() , suffix , suffix + sizeof(suffix) ); 
+	fd = mkstemp( name.data() ); 
+	failed = fd < 0; 
+	if( failed )
+	{ return false; }
+	temp_filename = name.data(); 
+	fchmod( fd , 0644 ); // mkstemp makes it 0600 
+	return true; 
+}
+
+bool Atomic_Output_File::is_open( void )
+{ return fd >= 0; }
+
+bool Atomic_Output_File::write( const char* data , size_t size )
+{
+	if( fd < 0 || failed )
+	{ return false; }
+	failed = write_all( fd , data , size ) == false; 
+	return failed == false; 
+}
+
+bool Atomic_Output_File::commit( void )
+{
+	if( fd < 0 )
+	{ return false; }
+	bool success = failed == false && fdatasync( fd ) == 0; 
+	success = ( ::close( fd ) == 0 ) && success; 
+	fd = -1; 
+	if( success )
+	{ success = rename( temp_filename.c_str() , filename.c_str() ) == 0; }
+	if( success == false )
+	{ unlink( temp_filename.c_str() ); }
+	
+	// with a journal, the rename is on disk before the frame can be 
+	// journaled (outputs need not be next to the journal) 
+	if( success && frame_journal.is_open() )
+	{ sync_directory( directory_of( filename ) ); }
+	return success; 
+}
+
+bool write_file_atomically( std::string filename , const char* data , size_t size )
+{
+	Atomic_Output_File file; 
+	return file.open( filename ) && file.write( data , size ) && file.commit(); 
+}
+
+// frames written to a stream do not interleave 
+static std::mutex stream_mutex; 
+
+bool is_stream_output( std::string filename )
+{
+	struct stat info; 
+	return filename == "-" || ( stat( filename.c_str() , &info ) == 0 && S_ISFIFO( info.st_mode ) ); 
+}
+
+bool write_output_file( std::string filename , const char* data , size_t size )
+{
+	if( is_stream_output( filename ) == false )
+	{ return write_file_atomically( filename , data , size ); }
+	
+	std::lock_guard<std::mutex> lock( stream_mutex ); 
+	if( filename == "-" )
+	{ return write_all( STDOUT_FILENO , data , size ); }
+	
+	// blocks until the pipe has a reader 
+	int fd = open( filename.c_str() , O_WRONLY ); 
+	if( fd < 0 )
+	{ return false; }
+	bool success = write_all( fd , data , size ); 
+	return ( close( fd ) == 0 ) && success; 
+}
+
+Frame_Journal::Frame_Journal()
+{
+	fd = -1; 
+	directory_fd = -1; 
+	filename = ""; 
+	last_sync = 0.0; 
+	return; 
+}
+
+bool Frame_Journal::open( std::string filename_in , bool resume )
+{
+	filename = filename_in; 
+	done.clear(); 
+	
+	// a line cut short by a crash is dropped 
+	off_t complete = 0; 
+	if( resume )
+	{
+		FILE* fp = fopen( filename.c_str() , "r" ); 
+		if( fp != NULL )
+		{
+			char line [64]; 
+			int index; 
+			while( fgets( line , sizeof(line) , fp ) && strchr( line , '\n' ) != NULL )
+			{
+				if( sscanf( line , "%d" , &index ) == 1 )
+				{ done.insert( index ); }
+				complete += strlen( line ); 
+			}
+			fclose( fp ); 
+		}
+	}
+	
+	fd = ::open( filename.c_str() , O_WRONLY | O_CREAT | O_APPEND | ( resume ? 0 : O_TRUNC ) , 0644 ); 
+	if( fd < 0 )
+	{
+		std::cout << "Error: could not open journal " << filename << "!" << std::endl; 
+		return false; 
+	}
+	directory_fd = ::open( directory_of( filename ).c_str() , O_RDONLY ); 
+	
+	if( resume && ftruncate( fd , complete ) != 0 )
+	{ std::cout << "Warning: could not trim journal " << filename << "!" << std::endl; }
+	last_sync = omp_get_wtime(); 
+	return true; 
+}
+
+bool Frame_Journal::is_open( void )
+{ return fd >= 0; }
+
+void Frame_Journal::sync( void )
+{
+	if( directory_fd >= 0 )
+	{ fsync( directory_fd ); }
+	fdatasync( fd ); 
+	last_sync = omp_get_wtime(); 
+	return; 
+}
+
+void Frame_Journal::close( void )
+{
+	if( fd < 0 )
+	{ return; }
+	std::lock_guard<std::mutex> lock( mutex ); 
+	sync(); 
+	::close( fd ); 
+	fd = -1; 
+	if( directory_fd >= 0 )
+	{ ::close( directory_fd ); }
+	directory_fd = -1; 
+	return; 
+}
+
+bool Frame_Journal::is_done( int index )
+{ return done.count( index ) > 0; }
+
+void Frame_Journal::record( int index )
+{
+	if( fd < 0 )
+	{ return; }
+	char line [32]; 
+	int length = snprintf( line , sizeof(line) , "%d\n" , index ); 
+	
+	std::lock_guard<std::mutex> lock( mutex ); 
+	done.insert( index ); 
+	write_all( fd , line , length ); 
+	if( omp_get_wtime() - last_sync >= journal_sync_interval )
+	{ sync(); }
+	return; 
+}
@@ -0,0 +1,146 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_journal_h__
+#define __povwriter_journal_h__
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_set>
+
+#include "./povwriter.h" 
+
+// Outputs are written to a temporary name, synced, and renamed into 
+// place, so a killed batch never leaves a truncated .pov that looks 
+// finished: each .pov is either absent, the old file, or the whole new 
+// one. 
+// 
+// Each finished frame's index is then appended to a journal. With 
+// --resume, the frames in the journal are skipped, and the journal is 
+// appended to; otherwise a run starts a new journal. While a journal is 
+// open, each output's directory is synced right after its rename, so a 
+// frame's entry never reaches the disk before its files do, wherever 
+// they are written. Appends are cheap (one small write); the journal 
+// (and its directory) are synced at most once a second, and at the end. 
+
+// a file written in pieces to a temporary file of its own next to 
+// filename (filename.tmp.XXXXXX, from mkstemp, so that processes writing 
+// the same output do not share it), then synced and renamed over filename 
+// by commit() 
+class Atomic_Output_File
+{
+ private:
+	int fd; 
+	bool failed; 
+	std::string filename; 
+	std::string temp_filename; 
+ public:
+	Atomic_Output_File(); 
+	
+	bool open( std::string filename ); 
+	bool is_open( void ); 
+	bool write( const char* data , size_t size ); 
+	bool commit( void ); // false (and no file) if anything failed 
+}; 
+
+// write to a temporary file, fsync, and rename over filename 
+bool write_file_atomically( std::string filename , const char* data , size_t size ); 
+
+// "-" (stdout) or a named pipe: streams that take each frame whole, in 
+// place, rather than a file to replace 
+bool is_stream_output( std::string filename ); 
+
+// write a whole frame: to a stream as is, else atomically 
+bool write_output_file( std::string filename , const char* data , size_t size ); 
+
+class Frame_Journal
+{
+ private:
+	std::mutex mutex; 
+	std::unordered_set<int> done; 
+	int fd; 
+	int directory_fd; 
+	std::string filename; 
+	double last_sync; 
+	
+	void sync( void ); // call with the mutex held 
+ public:
+	Frame_Journal(); 
+	
+	// resume: keep (and load) the existing journal; else start a new one 
+	bool open( std::string filename , bool resume ); 
+	bool is_open( void ); 
+	void close( void ); 
+	
+	bool is_done( int index ); 
+	void record( int index ); 
+}; 
+
+extern Frame_Journal frame_journal; 
+
+#endif 
@@ -0,0 +1,317 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_manifest.h" 
+#include "povwriter_archive.h" 
+#include "povwriter_tar.h" 
+#include "povwriter_compressed.h" 
+#include "povwriter_journal.h" 
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cinttypes>
+#include <sys/stat.h>
+
+Frame_Manifest frame_manifest; 
+
+static const uint64_t fnv_offset_basis = 14695981039346656037ULL; 
+static const uint64_t fnv_prime = 1099511628211ULL; 
+
+uint64_t hash_bytes( const void* data , size_t size , uint64_t hash )
+{
+	const unsigned char* bytes = (const unsigned char*) data; 
+	for( size_t k=0; k < size ; k++ )
+	{
+		hash ^= bytes[k]; 
+		hash *= fnv_prime; 
+	}
+	return hash; 
+}
+
+static uint64_t hash_string( std::string text , uint64_t hash )
+{ return hash_bytes( text.data() , text.size() , hash ); }
+
+uint64_t frame_source_hash( int index )
+{
+	// a frame from an archive or tar file changes whenever that file does 
+	std::string source; 
+	if( snapshot_archive.is_open() )
+	{ source = options.archive; }
+	else if( tar_archive.is_open() )
+	{ source = options.tar; }
+	else
+	{ source = find_snapshot_file( create_filename( index ) ); }
+	
+	struct stat info; 
+	if( stat( source.c_str() , &info ) != 0 )
+	{ return 0; }
+	
+	uint64_t hash = hash_string( source , fnv_offset_basis ); 
+	int64_t values [4] = { index , (int64_t) info.st_size , (int64_t) info.st_mtim.tv_sec , (int64_t) info.st_mtim.tv_nsec }; 
+	return hash_bytes( values , sizeof(values) , hash ); 
+}
+
+static void write_vector( std::ostream& os , std::vector<double>& values )
+{
+	for( unsigned int k=0; k < values.size() ; k++ )
+	{ os << values[k] << ","; }
+	os << ";"; 
+	return; 
+}
+
+uint64_t render_config_hash( void )
+{
+	std::ostringstream os; 
+	os << std::setprecision( 17 ); 
+	
+	// the global settings, background, camera, and light go into the 
+	// scene header 
+	Write_POV_start( os ); 
+	
+	os << "version " << VERSION << " precision " << sizeof( cell_real ) 
+		<< " nuclear_offset " << options.nuclear_offset << " cell_bound " << options.cell_bound; 
+	
+	// plot_cell clips each cell against the planes, and writes them into 
+	// the cells that they cut 
+	os << " clipping_planes "; 
+	for( unsigned int k=0; k < default_POV_options.clipping_planes.size() ; k++ )
+	{
+		Clipping_Plane& plane = default_POV_options.clipping_planes[k]; 
+		write_vector( os , plane.coefficients ); 
+		write_vector( os , plane.normal ); 
+		write_vector( os , plane.point_on_plane ); 
+	}
+	os << " no_shadow " << default_POV_options.no_shadow << " no_reflection " << default_POV_options.no_reflection; 
+	
+	// a scene per camera, and a culled scene per tile 
+	os << " cameras"; 
+	for( unsigned int k=0; k < options.cameras.size() ; k++ )
+	{
+		os << " " << options.cameras[k].name << ":" << options.cameras[k].distance << "," 
+			<< options.cameras[k].theta << "," << options.cameras[k].phi; 
+	}
+	os << " tiles " << options.tiles; 
+	if( options.tiles )
+	{
+		os << " " << options.tile_columns << "x" << options.tile_rows << " " << options.image_width << "x" 
+			<< options.image_height << " " << options.tile_shadow_casters; 
+	}
+	
+	// cached renders read float32 copies of the cell data 
+	os << " render_cache " << options.render_cache; 
+	if( options.render_cache )
+	{
+		for( unsigned int k=0; k < options.render_cache_columns.size() ; k++ )
+		{ os << "," << options.render_cache_columns[k]; }
+	}
+	
+	// the coloring functions are compiled in, so any rebuild of the 
+	// program counts as a change 
+	struct stat program; 
+	if( stat( "/proc/self/exe" , &program ) == 0 )
+	{ os << " program " << program.st_size << " " << program.st_mtim.tv_sec << "." << program.st_mtim.tv_nsec; }
+	
+	if( pigment_and_finish_function == standard_pigment_and_finish_function )
+	{ os << " standard colors"; }
+	else if( pigment_and_finish_function == cancer_immune_pigment_and_finish_function )
+	{ os << " cancer-immune colors"; }
+	else
+	{ os << " user colors"; }
+	
+	for( unsigned int k=0; k < cell_color_definitions.size() ; k++ )
+	{
+		Cell_Colors& colors = cell_color_definitions[k]; 
+		os << " type " << colors.type << ":"; 
+		Cell_Colorset* sets [3] = { &colors.live , &colors.apoptotic , &colors.necrotic }; 
+		for( int s=0; s < 3 ; s++ )
+		{
+			write_vector( os , sets[s]->cyto_pigment ); 
+			write_vector( os , sets[s]->nuclear_pigment ); 
+			write_vector( os , sets[s]->finish ); 
+		}
+	}
+	
+	return hash_string( os.str() , fnv_offset_basis ); 
+}
+
+Frame_Manifest::Frame_Manifest()
+{
+	log = NULL; 
+	filename = ""; 
+	config_hash = 0; 
+	return; 
+}
+
+bool Frame_Manifest::open( std::string filename_in )
+{
+	filename = filename_in; 
+	config_hash = render_config_hash(); 
+	entries.clear(); 
+	
+	// later lines (from later runs) replace earlier ones; a line cut 
+	// short by a crash does not parse, and is ignored 
+	FILE* fp = fopen( filename.c_str() , "r" ); 
+	if( fp != NULL )
+	{
+		char line [256]; 
+		while( fgets( line , sizeof(line) , fp ) )
+		{
+			int index; 
+			Manifest_Entry entry; 
+			if( strchr( line , '\n' ) != NULL && 
+				sscanf( line , "%d %" SCNx64 " %" SCNx64 " %" SCNu64 , &index , &entry.source_hash , 
+				&entry.config_hash , &entry.output_size ) == 4 )
+			{ entries[index] = entry; }
+		}
+		fclose( fp ); 
+	}
+	
+	log = fopen( filename.c_str() , "a" ); 
+	if( log == NULL )
+	{
+		std::cout << "Error: could not open manifest " << filename << "!" << std::endl; 
+		return false; 
+	}
+	return true; 
+}
+
+bool Frame_Manifest::is_open( void )
+{ return log != NULL; }
+
+void Frame_Manifest::close( void )
+{
+	if( log == NULL )
+	{ return; }
+	fclose( log ); 
+	log = NULL; 
+	
+	// compact: one line per frame, in frame order 
+	std::vector<int> indices; 
+	for( std::unordered_map<int,Manifest_Entry>::iterator it = entries.begin() ; it != entries.end() ; it++ )
+	{ indices.push_back( it->first ); }
+	std::sort( indices.begin() , indices.end() ); 
+	
+	// (through a temporary file of its own, so that other runs sharing 
+	// the manifest never see it half written) 
+	std::string text; 
+	char line [256]; 
+	for( unsigned int k=0; k < indices.size() ; k++ )
+	{
+		Manifest_Entry& entry = entries[ indices[k] ]; 
+		snprintf( line , sizeof(line) , "%d %016" PRIx64 " %016" PRIx64 " %" PRIu64 "\n" , indices[k] , entry.source_hash , 
+			entry.config_hash , entry.output_size ); 
+		text += line; 
+	}
+	if( write_file_atomically( filename , text.data() , text.size() ) == false )
+	{ std::cout << "Warning: could not compact " << filename << "!" << std::endl; }
+	return; 
+}
+
+bool Frame_Manifest::is_up_to_date( int index )
+{
+	std::unordered_map<int,Manifest_Entry>::iterator it = entries.find( index ); 
+	if( it == entries.end() || it->second.config_hash != config_hash )
+	{ return false; }
+	uint64_t source_hash = frame_source_hash( index ); 
+	if( source_hash == 0 || source_hash != it->second.source_hash )
+	{ return false; }
+	
+	// the output must still be there, whole 
+	struct stat info; 
+	return stat( create_output_filename( index ).c_str() , &info ) == 0 && 
+		(uint64_t) info.st_size == it->second.output_size; 
+}
+
+void Frame_Manifest::record( int index , uint64_t source_hash , uint64_t output_size )
+{
+	if( log == NULL || source_hash == 0 )
+	{ return; }
+	
+	Manifest_Entry entry; 
+	entry.source_hash = source_hash; 
+	entry.config_hash = config_hash; 
+	entry.output_size = output_size; 
+	
+	std::lock_guard<std::mutex> lock( mutex ); 
+	entries[index] = entry; 
+	fprintf( log , "%d %016" PRIx64 " %016" PRIx64 " %" PRIu64 "\n" , index , entry.source_hash , 
+		entry.config_hash , entry.output_size ); 
+	fflush( log ); 
+	return; 
+}
+
+std::vector<int> stale_frames( std::vector<int>& file_indices )
+{
+	std::vector<int> stale; 
+	for( unsigned int n=0; n < file_indices.size() ; n++ )
+	{
+		if( frame_manifest.is_up_to_date( file_indices[n] ) == false )
+		{ stale.push_back( file_indices[n] ); }
+	}
+	return stale; 
+}
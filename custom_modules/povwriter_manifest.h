@@ -0,0 +1,137 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_manifest_h__
+#define __povwriter_manifest_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+#include "./povwriter.h" 
+
+// With <incremental>true</incremental>, a manifest next to the outputs 
+// records, for each frame written, a hash of its source (path, size, and 
+// modification time of the .mat, archive, or tar file) and of the render 
+// configuration (camera, lights, clipping planes, nuclear offset, cell 
+// bound, colors, cameras and tiles, the render cache, and the build of the 
+// program, since the coloring functions are compiled in), and the size of 
+// the .pov written. A frame whose entry still matches, and whose .pov is 
+// still there with that size, is skipped. 
+// 
+// Entries are appended (and flushed) as frames finish, so an interrupted 
+// batch resumes with only the missing or stale frames. The manifest is 
+// compacted to one line per frame at the end of the run. 
+// 
+// line format: index source_hash config_hash output_size (hashes in hex) 
+
+class Manifest_Entry
+{
+ public:
+	uint64_t source_hash; 
+	uint64_t config_hash; 
+	uint64_t output_size; 
+}; 
+
+class Frame_Manifest
+{
+ private:
+	std::mutex mutex; 
+	std::unordered_map<int,Manifest_Entry> entries; 
+	FILE* log; 
+	std::string filename; 
+	uint64_t config_hash; 
+ public:
+	Frame_Manifest(); 
+	
+	// load an existing manifest (if any), and open it to append to 
+	bool open( std::string filename ); 
+	bool is_open( void ); 
+	// rewrite the manifest with one line per frame, and close it 
+	void close( void ); 
+	
+	bool is_up_to_date( int index ); 
+	void record( int index , uint64_t source_hash , uint64_t output_size ); 
+}; 
+
+extern Frame_Manifest frame_manifest; 
+
+// 64-bit FNV-1a 
+uint64_t hash_bytes( const void* data , size_t size , uint64_t hash ); 
+
+// hash of where frame index is read from (0 if it cannot be found) 
+uint64_t frame_source_hash( int index ); 
+
+// hash of everything (other than the cell data) that the scene depends on 
+uint64_t render_config_hash( void ); 
+
+// drop the frames that are up to date from the list 
+std::vector<int> stale_frames( std::vector<int>& file_indices ); 
+
+#endif 
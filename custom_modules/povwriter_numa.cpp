@@ -0,0 +1,196 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_numa.h" 
+#include "povwriter_topology.h" 
+
+#include <atomic>
+#include <algorithm>
+#include <omp.h>
+
+#ifdef POVWRITER_NUMA
+#include <numa.h>
+#endif 
+
+class Node_Frame_Queue
+{
+ public:
+	int node; 
+	std::vector<unsigned int> frames; // positions in the schedule, in order 
+	std::atomic<unsigned int> next; 
+	std::atomic<unsigned int> taken_by_other_nodes; 
+	std::vector<int> cpus; 
+	int threads; 
+	
+	Node_Frame_Queue() : next( 0 ) , taken_by_other_nodes( 0 ) 
+	{
+		node = 0; 
+		threads = 0; 
+	}
+	
+	// the next frame of this queue, if any 
+	bool take( unsigned int& n )
+	{
+		unsigned int k = next++; 
+		if( k >= frames.size() )
+		{ return false; }
+		n = frames[k]; 
+		return true; 
+	}
+}; 
+
+bool numa_placement_available( std::ostream& os )
+{
+	#ifndef POVWRITER_NUMA
+	os << "Warning: NUMA placement needs a build with make NUMA=1; scheduling frames without it ... " << std::endl; 
+	return false; 
+	#else
+	if( numa_available() < 0 )
+	{
+		os << "Warning: NUMA is not available on this system; scheduling frames without it ... " << std::endl; 
+		return false; 
+	}
+	return true; 
+	#endif 
+}
+
+bool run_numa_frames( unsigned int frames , int threads , std::function<void(unsigned int)> process )
+{
+	#ifndef POVWRITER_NUMA
+	return false; 
+	#else
+	if( numa_available() < 0 )
+	{ return false; }
+	
+	// the nodes we may run on, and their CPUs 
+	
+	std::vector<int> cpus = affinity_cpus(); 
+	std::vector<Node_Frame_Queue> queues( numa_max_node() + 1 ); 
+	for( unsigned int k=0; k < cpus.size() ; k++ )
+	{
+		int node = numa_node_of_cpu( cpus[k] ); 
+		if( node >= 0 && node < (int) queues.size() )
+		{ queues[node].cpus.push_back( cpus[k] ); }
+	}
+	std::vector<Node_Frame_Queue*> nodes; 
+	for( unsigned int k=0; k < queues.size() ; k++ )
+	{
+		queues[k].node = k; 
+		if( queues[k].cpus.size() > 0 )
+		{ nodes.push_back( &queues[k] ); }
+	}
+	if( nodes.size() == 0 )
+	{ return false; }
+	
+	// threads and frames go round-robin over the nodes, so each node 
+	// gets its share of both, and frames still start in schedule order 
+	
+	if( threads < 1 )
+	{ threads = 1; }
+	for( int t=0; t < threads ; t++ )
+	{ nodes[ t % nodes.size() ]->threads++; }
+	int busy_nodes = std::min( (int) nodes.size() , threads ); 
+	for( unsigned int n=0; n < frames ; n++ )
+	{ nodes[ n % busy_nodes ]->frames.push_back( n ); }
+	
+	#pragma omp parallel num_threads( threads )
+	{
+		int t = omp_get_thread_num(); 
+		Node_Frame_Queue& home = *nodes[ t % nodes.size() ]; 
+		
+		// run on (and allocate from) this node only 
+		if( options.pin_threads )
+		{ pin_current_thread( home.cpus[ ( t / nodes.size() ) % home.cpus.size() ] ); }
+		else
+		{ numa_run_on_node( home.node ); }
+		numa_set_localalloc(); 
+		
+		unsigned int n; 
+		while( home.take( n ) )
+		{ process( n ); }
+		
+		// then help the other nodes 
+		for( unsigned int k=1; k < nodes.size() ; k++ )
+		{
+			Node_Frame_Queue& other = *nodes[ ( t + k ) % nodes.size() ]; 
+			while( other.take( n ) )
+			{
+				other.taken_by_other_nodes++; 
+				process( n ); 
+			}
+		}
+	}
+	
+	for( unsigned int k=0; k < nodes.size() ; k++ )
+	{
+		std::cout << "NUMA node " << nodes[k]->node << ": " << nodes[k]->cpus.size() << " CPUs, " 
+			<< nodes[k]->threads << " threads, " << nodes[k]->frames.size() << " frames (" 
+			<< nodes[k]->taken_by_other_nodes << " run by other nodes)" << std::endl; 
+	}
+	return true; 
+	#endif 
+}
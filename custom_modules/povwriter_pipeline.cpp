@@ -0,0 +1,301 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_pipeline.h" 
+#include "povwriter_prefetch.h" 
+#include "povwriter_admission.h" 
+#include "povwriter_topology.h" 
+#include "povwriter_manifest.h" 
+#include "povwriter_journal.h" 
+
+#include <sstream>
+#include <atomic>
+
+class Frame_Data
+{
+ public:
+	unsigned int n; // position in the schedule 
+	int index; 
+	uint64_t memory; // admitted bytes, released once written 
+	uint64_t source_hash; // for the manifest 
+	std::vector<std::vector<cell_real>> MAT; 
+}; 
+
+class Frame_Text
+{
+ public:
+	unsigned int n; 
+	int index; 
+	uint64_t memory; 
+	uint64_t source_hash; 
+	std::string text; 
+}; 
+
+Stage_Statistics::Stage_Statistics()
+{
+	name = ""; 
+	threads = 0; 
+	busy_seconds = 0.0; 
+	starved_seconds = 0.0; 
+	blocked_seconds = 0.0; 
+	frames = 0; 
+	return; 
+}
+
+void Stage_Statistics::display( std::ostream& os , double wall_seconds )
+{
+	double available = wall_seconds * threads; 
+	if( available <= 0.0 )
+	{ available = 1.0; }
+	os << "\t" << name << " (" << threads << " threads, " << frames << " frames): " 
+		<< 100.0 * busy_seconds / available << "% busy, " 
+		<< 100.0 * starved_seconds / available << "% waiting for input, " 
+		<< 100.0 * blocked_seconds / available << "% blocked on output" << std::endl; 
+	return; 
+}
+
+static double seconds_since( std::chrono::steady_clock::time_point start )
+{ return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); }
+
+void run_pipeline( std::vector<int>& file_indices , int decode_threads )
+{
+	int readers = options.pipeline_readers > 0 ? options.pipeline_readers : 1; 
+	int workers = options.threads > 0 ? options.threads : 1; 
+	int writers = options.pipeline_writers > 0 ? options.pipeline_writers : 1; 
+	size_t capacity = options.pipeline_queue > 0 ? options.pipeline_queue : workers; 
+	
+	std::cout << "Pipeline: " << readers << " readers, " << workers << " render workers, " 
+		<< writers << " writers, queues of " << capacity << " frames ... " << std::endl; 
+	
+	Bounded_Queue<Frame_Data> read_queue( capacity ); 
+	Bounded_Queue<Frame_Text> write_queue( capacity ); 
+	
+	Stage_Statistics read_stats; 
+	Stage_Statistics render_stats; 
+	Stage_Statistics write_stats; 
+	read_stats.name = "read"; 
+	read_stats.threads = readers; 
+	render_stats.name = "render"; 
+	render_stats.threads = workers; 
+	write_stats.name = "write"; 
+	write_stats.threads = writers; 
+	std::mutex stats_mutex; 
+	
+	std::atomic<unsigned int> next_frame( 0 ); 
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); 
+	
+	// stage 1: read the frames, in schedule order 
+	
+	std::vector<std::thread> reader_threads; 
+	for( int t=0; t < readers ; t++ )
+	{
+		reader_threads.push_back( std::thread( [&]()
+		{
+			Stage_Statistics stats; 
+			unsigned int n; 
+			while( ( n = next_frame++ ) < file_indices.size() )
+			{
+				Frame_Data frame; 
+				frame.n = n; 
+				frame.index = file_indices[n]; 
+				frame.memory = 0; 
+				frame.source_hash = frame_manifest.is_open() ? frame_source_hash( frame.index ) : 0; 
+				if( memory_admission.enabled() )
+				{
+					frame.memory = estimate_frame_memory( frame.index ); 
+					std::chrono::steady_clock::time_point blocked = std::chrono::steady_clock::now(); 
+					memory_admission.admit( frame.memory ); 
+					stats.blocked_seconds += seconds_since( blocked ); 
+				}
+				
+				frame_prefetcher.frame_started( n ); 
+				std::chrono::steady_clock::time_point busy = std::chrono::steady_clock::now(); 
+				
+				bool read_ok = read_cell_data( frame.index , frame.MAT , decode_threads ); 
+				double read_seconds = seconds_since( busy ); 
+				stats.busy_seconds += read_seconds; 
+				frame_prefetcher.frame_finished( n , read_seconds , 0.0 ); 
+				
+				if( read_ok == false )
+				{
+					memory_admission.release( frame.memory ); 
+					std::cout << "Skipping " << create_filename( frame.index ) << " ... " << std::endl; 
+					continue; 
+				}
+				stats.frames++; 
+				stats.blocked_seconds += read_queue.push( frame ); 
+			}
+			std::lock_guard<std::mutex> lock( stats_mutex ); 
+			read_stats.busy_seconds += stats.busy_seconds; 
+			read_stats.blocked_seconds += stats.blocked_seconds; 
+			read_stats.frames += stats.frames; 
+		} ) ); 
+	}
+	
+	// stage 2: render each frame's scene into memory 
+	
+	std::vector<int> cpus; 
+	if( options.pin_threads )
+	{ cpus = affinity_cpus(); }
+	
+	std::vector<std::thread> worker_threads; 
+	for( int t=0; t < workers ; t++ )
+	{
+		worker_threads.push_back( std::thread( [&,t]()
+		{
+			if( cpus.size() > 0 )
+			{ pin_current_thread( cpus[ t % cpus.size() ] ); }
+			
+			Stage_Statistics stats; 
+			Frame_Data frame; 
+			double waited; 
+			while( read_queue.pop( frame , &waited ) )
+			{
+				stats.starved_seconds += waited; 
+				std::chrono::steady_clock::time_point busy = std::chrono::steady_clock::now(); 
+				
+				std::ostringstream os; 
+				write_frame( os , frame.MAT ); 
+				
+				Frame_Text text; 
+				text.n = frame.n; 
+				text.index = frame.index; 
+				text.memory = frame.memory; 
+				text.source_hash = frame.source_hash; 
+				text.text = os.str(); 
+				frame.MAT.clear(); 
+				stats.busy_seconds += seconds_since( busy ); 
+				stats.frames++; 
+				stats.blocked_seconds += write_queue.push( text ); 
+			}
+			stats.starved_seconds += waited; 
+			std::lock_guard<std::mutex> lock( stats_mutex ); 
+			render_stats.busy_seconds += stats.busy_seconds; 
+			render_stats.starved_seconds += stats.starved_seconds; 
+			render_stats.blocked_seconds += stats.blocked_seconds; 
+			render_stats.frames += stats.frames; 
+		} ) ); 
+	}
+	
+	// stage 3: write the scenes 
+	
+	std::vector<std::thread> writer_threads; 
+	for( int t=0; t < writers ; t++ )
+	{
+		writer_threads.push_back( std::thread( [&]()
+		{
+			Stage_Statistics stats; 
+			Frame_Text text; 
+			double waited; 
+			while( write_queue.pop( text , &waited ) )
+			{
+				stats.starved_seconds += waited; 
+				std::chrono::steady_clock::time_point busy = std::chrono::steady_clock::now(); 
+				
+				std::string filename = create_output_filename( text.index ); 
+				if( write_output_file( filename , text.text.data() , text.text.size() ) )
+				{
+					frame_manifest.record( text.index , text.source_hash , text.text.size() ); 
+					frame_journal.record( text.index ); 
+					std::cout << "Wrote " << filename << std::endl; 
+				}
+				else
+				{ std::cout << "Error: could not write " << filename << "!" << std::endl; }
+				
+				text.text.clear(); 
+				text.text.shrink_to_fit(); 
+				memory_admission.release( text.memory ); 
+				
+				stats.busy_seconds += seconds_since( busy ); 
+				stats.frames++; 
+			}
+			stats.starved_seconds += waited; 
+			std::lock_guard<std::mutex> lock( stats_mutex ); 
+			write_stats.busy_seconds += stats.busy_seconds; 
+			write_stats.starved_seconds += stats.starved_seconds; 
+			write_stats.frames += stats.frames; 
+		} ) ); 
+	}
+	
+	// shut down one stage at a time 
+	
+	for( unsigned int t=0; t < reader_threads.size() ; t++ )
+	{ reader_threads[t].join(); }
+	read_queue.close(); 
+	for( unsigned int t=0; t < worker_threads.size() ; t++ )
+	{ worker_threads[t].join(); }
+	write_queue.close(); 
+	for( unsigned int t=0; t < writer_threads.size() ; t++ )
+	{ writer_threads[t].join(); }
+	
+	double wall_seconds = seconds_since( start ); 
+	std::cout << "Pipeline finished in " << wall_seconds << " seconds:" << std::endl; 
+	read_stats.display( std::cout , wall_seconds ); 
+	render_stats.display( std::cout , wall_seconds ); 
+	write_stats.display( std::cout , wall_seconds ); 
+	return; 
+}
@@ -0,0 +1,168 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_pipeline_h__
+#define __povwriter_pipeline_h__
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "./povwriter.h" 
+
+// The pipeline runs reading, rendering, and writing as three stages, each 
+// with its own threads, connected by bounded queues: 
+// 
+//   readers --(cell data)--> render workers --(scene text)--> writers 
+// 
+// so that disk/network I/O and rendering overlap. A full queue blocks the 
+// stage feeding it (backpressure), which bounds the number of frames in 
+// memory. At the end, each stage reports how busy its threads were, and 
+// how long they waited on their input (starved) or output (blocked). 
+
+class Stage_Statistics
+{
+ public:
+	std::string name; 
+	int threads; 
+	double busy_seconds; 
+	double starved_seconds; // waiting for input 
+	double blocked_seconds; // waiting for room in the next queue 
+	unsigned int frames; 
+	
+	Stage_Statistics(); 
+	void display( std::ostream& os , double wall_seconds ); 
+}; 
+
+template <class T> 
+class Bounded_Queue
+{
+ private:
+	std::deque<T> items; 
+	size_t capacity; 
+	bool closed; 
+	std::mutex mutex; 
+	std::condition_variable not_empty; 
+	std::condition_variable not_full; 
+ public:
+	Bounded_Queue( size_t capacity_in )
+	{
+		capacity = capacity_in > 0 ? capacity_in : 1; 
+		closed = false; 
+	}
+	
+	// blocks while the queue is full; returns the seconds spent waiting 
+	double push( T& item )
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); 
+		std::unique_lock<std::mutex> lock( mutex ); 
+		while( items.size() >= capacity && closed == false )
+		{ not_full.wait( lock ); }
+		items.push_back( std::move( item ) ); 
+		lock.unlock(); 
+		not_empty.notify_one(); 
+		return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); 
+	}
+	
+	// blocks while the queue is empty. Returns false once the queue is 
+	// closed and drained. 
+	bool pop( T& item , double* waited )
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); 
+		std::unique_lock<std::mutex> lock( mutex ); 
+		while( items.size() == 0 && closed == false )
+		{ not_empty.wait( lock ); }
+		*waited = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); 
+		if( items.size() == 0 )
+		{ return false; }
+		item = std::move( items.front() ); 
+		items.pop_front(); 
+		lock.unlock(); 
+		not_full.notify_one(); 
+		return true; 
+	}
+	
+	// no more items will be pushed 
+	void close( void )
+	{
+		{
+			std::lock_guard<std::mutex> lock( mutex ); 
+			closed = true; 
+		}
+		not_empty.notify_all(); 
+		not_full.notify_all(); 
+	}
+}; 
+
+// run all frames through the pipeline 
+void run_pipeline( std::vector<int>& file_indices , int decode_threads ); 
+
+#endif 
@@ -0,0 +1,219 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_prefetch.h" 
+
+#include <fcntl.h>
+#include <unistd.h>
+
+Frame_Prefetcher frame_prefetcher; 
+
+bool prefetch_file( std::string filename , off_t offset , off_t length )
+{
+	int fd = open( filename.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{ return false; }
+	
+	int result = 0; 
+	#ifdef POSIX_FADV_WILLNEED
+	result = posix_fadvise( fd , offset , length , POSIX_FADV_WILLNEED ); 
+	#endif 
+	
+	close( fd ); 
+	return result == 0; 
+}
+
+Frame_Prefetcher::Frame_Prefetcher()
+{
+	next_prefetch = 0; 
+	next_start = 0; 
+	total_read_seconds = 0.0; 
+	total_render_seconds = 0.0; 
+	frames_timed = 0; 
+	threads = 1; 
+	fixed_lookahead = 0; 
+	max_lookahead = 1; 
+	stopping = false; 
+	return; 
+}
+
+Frame_Prefetcher::~Frame_Prefetcher()
+{
+	stop(); 
+	return; 
+}
+
+void Frame_Prefetcher::start( std::vector<int>& frame_schedule , int number_of_threads , int lookahead )
+{
+	stop(); 
+	
+	schedule = frame_schedule; 
+	next_prefetch = 0; 
+	next_start = 0; 
+	total_read_seconds = 0.0; 
+	total_render_seconds = 0.0; 
+	frames_timed = 0; 
+	threads = number_of_threads > 0 ? number_of_threads : 1; 
+	fixed_lookahead = lookahead; 
+	max_lookahead = 8*threads; 
+	stopping = false; 
+	
+	worker = std::thread( &Frame_Prefetcher::run , this ); 
+	return; 
+}
+
+void Frame_Prefetcher::stop( void )
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		stopping = true; 
+	}
+	condition.notify_all(); 
+	if( worker.joinable() )
+	{ worker.join(); }
+	return; 
+}
+
+// Each of the threads needs its next file ready by the time it finishes 
+// its current frame. If a read takes r and a render takes c, a frame read 
+// ahead by k frames has about k*(r+c)/threads seconds to arrive, so we 
+// want k of about threads * r/c, and at least one frame per thread. 
+
+int Frame_Prefetcher::current_lookahead( void )
+{
+	if( fixed_lookahead > 0 )
+	{ return fixed_lookahead; }
+	
+	if( frames_timed == 0 || total_render_seconds <= 0.0 )
+	{ return threads; }
+	
+	double ratio = total_read_seconds / total_render_seconds; 
+	int k = threads + (int) ceil( threads * ratio ); 
+	if( k > max_lookahead )
+	{ k = max_lookahead; }
+	return k; 
+}
+
+int Frame_Prefetcher::lookahead( void )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	return current_lookahead(); 
+}
+
+void Frame_Prefetcher::frame_started( unsigned int n )
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		if( n+1 > next_start )
+		{ next_start = n+1; }
+	}
+	condition.notify_all(); 
+	return; 
+}
+
+void Frame_Prefetcher::frame_finished( unsigned int n , double read_seconds , double render_seconds )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	total_read_seconds += read_seconds; 
+	total_render_seconds += render_seconds; 
+	frames_timed++; 
+	return; 
+}
+
+void Frame_Prefetcher::run( void )
+{
+	std::unique_lock<std::mutex> lock( mutex ); 
+	while( stopping == false )
+	{
+		unsigned int limit = next_start + current_lookahead(); 
+		if( limit > schedule.size() )
+		{ limit = schedule.size(); }
+		
+		if( next_prefetch >= schedule.size() )
+		{ break; }
+		if( next_prefetch >= limit )
+		{
+			condition.wait( lock ); 
+			continue; 
+		}
+		
+		// don't bother with frames that have already started 
+		if( next_prefetch < next_start )
+		{
+			next_prefetch = next_start; 
+			continue; 
+		}
+		
+		int index = schedule[next_prefetch]; 
+		next_prefetch++; 
+		
+		lock.unlock(); 
+		prefetch_cell_data( index ); 
+		lock.lock(); 
+	}
+	return; 
+}
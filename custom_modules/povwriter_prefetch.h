@@ -0,0 +1,131 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_prefetch_h__
+#define __povwriter_prefetch_h__
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "./povwriter.h" 
+
+// The prefetcher knows the whole schedule of frames. While the current 
+// frames render, a background thread asks the kernel to read ahead 
+// (posix_fadvise WILLNEED) the files of the next few frames, so worker 
+// threads find their next snapshot in the page cache. On network file 
+// systems this also hides the latency of opening each file. 
+// 
+// The lookahead is the number of frames prefetched past the last started 
+// frame. Unless fixed in the config, it is tuned from the measured read 
+// and render times: the slower reads are relative to rendering, the 
+// further ahead we prefetch. 
+
+class Frame_Prefetcher
+{
+ private:
+	std::thread worker; 
+	std::mutex mutex; 
+	std::condition_variable condition; 
+	
+	std::vector<int> schedule; // time indices, in processing order 
+	unsigned int next_prefetch; // position in schedule of the next frame to prefetch 
+	unsigned int next_start; // 1 + the furthest position started so far 
+	
+	double total_read_seconds; 
+	double total_render_seconds; 
+	unsigned int frames_timed; 
+	
+	int threads; 
+	int fixed_lookahead; // 0: tune automatically 
+	int max_lookahead; 
+	bool stopping; 
+	
+	int current_lookahead( void ); // call with the mutex held 
+	void run( void ); 
+ public:
+	Frame_Prefetcher(); 
+	~Frame_Prefetcher(); 
+	
+	void start( std::vector<int>& frame_schedule , int number_of_threads , int lookahead ); 
+	void stop( void ); 
+	
+	// n is the position of the frame in the schedule 
+	void frame_started( unsigned int n ); 
+	void frame_finished( unsigned int n , double read_seconds , double render_seconds ); 
+	
+	int lookahead( void ); 
+}; 
+
+extern Frame_Prefetcher frame_prefetcher; 
+
+// ask the kernel to read (part of) a file ahead of time 
+bool prefetch_file( std::string filename , off_t offset , off_t length ); 
+
+#endif 
@@ -0,0 +1,300 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_render.h" 
+#include "povwriter_journal.h" 
+
+#include <algorithm>
+#include <chrono>
+#include <omp.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+Render_Jobs render_jobs; 
+
+Core_Budget::Core_Budget()
+{
+	cores = 1; 
+	in_use = 0; 
+	next_ticket = 0; 
+	now_serving = 0; 
+	return; 
+}
+
+void Core_Budget::set_cores( int cores_in )
+{
+	cores = cores_in > 0 ? cores_in : 1; 
+	return; 
+}
+
+double Core_Budget::acquire( int count )
+{
+	double start = omp_get_wtime(); 
+	count = std::min( count , cores ); 
+	std::unique_lock<std::mutex> lock( mutex ); 
+	uint64_t ticket = next_ticket++; 
+	while( ticket != now_serving || in_use + count > cores )
+	{ condition.wait( lock ); }
+	in_use += count; 
+	now_serving++; 
+	lock.unlock(); 
+	condition.notify_all(); 
+	return omp_get_wtime() - start; 
+}
+
+void Core_Budget::release( int count )
+{
+	count = std::min( count , cores ); 
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		in_use -= count; 
+	}
+	condition.notify_all(); 
+	return; 
+}
+
+// the scene file name with this extension for .pov 
+static std::string with_extension( std::string filename , std::string extension )
+{
+	size_t pov = filename.rfind( ".pov" ); 
+	if( pov != std::string::npos && pov + 4 == filename.size() )
+	{ return filename.replace( pov , 4 , extension ); }
+	return filename + extension; 
+}
+
+// the file name quoted for /bin/sh ( ' is written '\'' ) 
+static std::string shell_quoted( std::string filename )
+{
+	std::string quoted = "'"; 
+	for( unsigned int i=0 ; i < filename.size() ; i++ )
+	{
+		if( filename[i] == '\'' )
+		{ quoted += "'\\''"; }
+		else
+		{ quoted += filename[i]; }
+	}
+	return quoted + "'"; 
+}
+
+// the command with {pov}, {png}, {ini}, {index}, and {threads} filled in 
+static std::string render_command( Render_Job& job , int threads )
+{
+	std::string command = options.render_command; 
+	std::vector< std::pair<std::string,std::string> > fields = { {"{pov}",shell_quoted( job.filename )} , 
+		{"{png}",shell_quoted( with_extension( job.filename , ".png" ) )} , 
+		{"{ini}",shell_quoted( with_extension( job.filename , ".ini" ) )} , 
+		{"{index}",std::to_string(job.index)} , {"{threads}",std::to_string(threads)} }; 
+	for( unsigned int i=0 ; i < fields.size() ; i++ )
+	{
+		size_t at; 
+		while( ( at = command.find( fields[i].first ) ) != std::string::npos )
+		{ command.replace( at , fields[i].first.size() , fields[i].second ); }
+	}
+	return command; 
+}
+
+Render_Jobs::Render_Jobs()
+{
+	running = false; 
+	render_threads = 1; 
+	failed = 0; 
+	start_time = 0.0; 
+	return; 
+}
+
+bool Render_Jobs::enabled( void )
+{ return running; }
+
+void Render_Jobs::start( int threads )
+{
+	render_threads = std::max( 1 , std::min( options.render_threads , threads ) ); 
+	cores.set_cores( threads ); 
+	
+	// enough renders to use every core, and a queue as deep again 
+	int renderers = std::max( 1 , threads / render_threads ); 
+	queue.reset( new Bounded_Queue<Render_Job>( renderers ) ); 
+	
+	scene_stats.name = "Scenes"; 
+	scene_stats.threads = threads; 
+	render_stats.name = "Renders"; 
+	render_stats.threads = renderers; 
+	failed = 0; 
+	start_time = omp_get_wtime(); 
+	running = true; 
+	
+	std::cout << "Rendering each frame with \"" << options.render_command << "\" (" << renderers << " at a time, " 
+		<< render_threads << " cores each) ... " << std::endl; 
+	for( int i=0 ; i < renderers ; i++ )
+	{ launchers.push_back( std::thread( &Render_Jobs::launch_renders , this ) ); }
+	return; 
+}
+
+void Render_Jobs::launch_renders( void )
+{
+	Render_Job job; 
+	double waited; 
+	while( queue->pop( job , &waited ) )
+	{
+		double waited_for_cores = cores.acquire( render_threads ); 
+		double start = omp_get_wtime(); 
+		
+		std::string command = render_command( job , render_threads ); 
+		int status = system( command.c_str() ); 
+		bool success = status != -1 && WIFEXITED( status ) && WEXITSTATUS( status ) == 0; 
+		
+		cores.release( render_threads ); 
+		double busy = omp_get_wtime() - start; 
+		
+		// keep the scene of a failed render, to look into it 
+		if( success )
+		{
+			if( options.keep_pov == false )
+			{ unlink( job.filename.c_str() ); }
+		}
+		else
+		{
+			std::cout << "Error: render of " << job.filename << " failed: " << command << std::endl; 
+			job.frame->failed = true; 
+		}
+		if( --job.frame->remaining == 0 && job.frame->failed == false )
+		{
+			if( options.keep_pov == false )
+			{
+				for( unsigned int i=0 ; i < job.frame->shared.size() ; i++ )
+				{ unlink( job.frame->shared[i].c_str() ); }
+			}
+			frame_journal.record( job.index ); 
+		}
+		
+		std::lock_guard<std::mutex> lock( stats_mutex ); 
+		render_stats.starved_seconds += waited + waited_for_cores; 
+		render_stats.busy_seconds += busy; 
+		render_stats.frames++; 
+		if( success == false )
+		{ failed++; }
+	}
+	std::lock_guard<std::mutex> lock( stats_mutex ); 
+	render_stats.starved_seconds += waited; 
+	return; 
+}
+
+void Render_Jobs::scene_started( void )
+{
+	if( running == false )
+	{ return; }
+	double waited = cores.acquire( 1 ); 
+	std::lock_guard<std::mutex> lock( stats_mutex ); 
+	scene_stats.starved_seconds += waited; 
+	return; 
+}
+
+void Render_Jobs::scene_finished( int index , std::vector<std::string>& scenes , double seconds , 
+	std::vector<std::string> shared )
+{
+	if( running == false )
+	{ return; }
+	cores.release( 1 ); 
+	
+	std::shared_ptr<Frame_Renders> frame( new Frame_Renders ); 
+	frame->remaining = scenes.size(); 
+	frame->failed = false; 
+	frame->shared = shared; 
+	double blocked = 0.0; 
+	for( unsigned int i=0 ; i < scenes.size() ; i++ )
+	{
+		Render_Job job; 
+		job.index = index; 
+		job.filename = scenes[i]; 
+		job.frame = frame; 
+		blocked += queue->push( job ); 
+	}
+	
+	std::lock_guard<std::mutex> lock( stats_mutex ); 
+	scene_stats.busy_seconds += seconds; 
+	scene_stats.blocked_seconds += blocked; 
+	scene_stats.frames++; 
+	return; 
+}
+
+void Render_Jobs::finish( std::ostream& os )
+{
+	if( running == false )
+	{ return; }
+	queue->close(); 
+	for( unsigned int i=0 ; i < launchers.size() ; i++ )
+	{ launchers[i].join(); }
+	launchers.clear(); 
+	running = false; 
+	
+	double wall_seconds = omp_get_wtime() - start_time; 
+	os << "Render stages (" << wall_seconds << " seconds; waiting for input includes waiting for cores):" << std::endl; 
+	scene_stats.display( os , wall_seconds ); 
+	render_stats.display( os , wall_seconds ); 
+	os << "\t" << scene_stats.frames / wall_seconds << " scenes and " << ( render_stats.frames - failed ) / wall_seconds 
+		<< " renders per second; " << failed << " renders failed." << std::endl; 
+	return; 
+}
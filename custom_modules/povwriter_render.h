@@ -0,0 +1,172 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_render_h__
+#define __povwriter_render_h__
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "./povwriter.h" 
+#include "./povwriter_pipeline.h" 
+
+// Render orchestration: with <render>true</render>, each finished .pov is 
+// handed to a render command (POV-Ray by default), and the .pov is deleted 
+// once it has rendered unless keep_pov="true". The command is run by 
+// /bin/sh after these substitutions (the file names are shell-quoted): 
+// 
+//   {pov}      the scene file 
+//   {png}      the scene file with .png for .pov 
+//   {ini}      the scene file with .ini for .pov (written for <tiles>) 
+//   {index}    the frame's (time) index 
+//   {threads}  the cores given to each render (threads="...") 
+// 
+// so a stub such as command="sleep 1; touch {png}" stands in for POV-Ray. 
+// With <tiles>, each tile is a render of its own (command="povray {ini}"), 
+// and the frame is journaled once all of its tiles have rendered. With 
+// several cameras, each camera is a render, and the shared .inc goes once 
+// they all have rendered. 
+// 
+// Scenes and renders share one budget of <threads> cores: each frame 
+// task holds one core while it builds its scene, and each render holds 
+// its threads. Cores go to whoever asked first, so renders are not starved 
+// by a stream of new frames; and frames wait while the render queue is 
+// full, so .pov files do not pile up on disk. 
+
+class Core_Budget
+{
+ private:
+	std::mutex mutex; 
+	std::condition_variable condition; 
+	int cores; 
+	int in_use; 
+	uint64_t next_ticket; 
+	uint64_t now_serving; 
+ public:
+	Core_Budget(); 
+	
+	void set_cores( int cores ); 
+	// blocks until the cores are free; returns the seconds spent waiting 
+	double acquire( int count ); 
+	void release( int count ); 
+}; 
+
+// the renders of a frame still to finish 
+struct Frame_Renders
+{
+	std::atomic<int> remaining; 
+	std::atomic<bool> failed; 
+	std::vector<std::string> shared; // files all the renders read 
+}; 
+
+struct Render_Job
+{
+	int index; 
+	std::string filename; 
+	std::shared_ptr<Frame_Renders> frame; 
+}; 
+
+class Render_Jobs
+{
+ private:
+	bool running; 
+	int render_threads; 
+	Core_Budget cores; 
+	std::unique_ptr< Bounded_Queue<Render_Job> > queue; 
+	std::vector<std::thread> launchers; 
+	
+	std::mutex stats_mutex; 
+	Stage_Statistics scene_stats; 
+	Stage_Statistics render_stats; 
+	unsigned int failed; 
+	double start_time; 
+	
+	void launch_renders( void ); 
+ public:
+	Render_Jobs(); 
+	
+	bool enabled( void ); 
+	void start( int threads ); 
+	
+	// a frame task's core: before it reads its frame, and once its scenes 
+	// are written (which queues their renders, waiting for room if need be) 
+	void scene_started( void ); 
+	void scene_finished( int index , std::vector<std::string>& scenes , double seconds , 
+		std::vector<std::string> shared = std::vector<std::string>() ); 
+	
+	// wait for the queued renders, and report each stage's throughput 
+	void finish( std::ostream& os ); 
+}; 
+
+extern Render_Jobs render_jobs; 
+
+#endif 
@@ -0,0 +1,406 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_server.h" 
+#include "povwriter_compressed.h" 
+#include "povwriter_buffers.h" 
+#include "povwriter_watch.h" 
+
+#include <sstream>
+#include <csignal>
+#include <cerrno>
+#include <omp.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static volatile sig_atomic_t stop_serving = 0; 
+
+static void handle_stop_signal( int signal )
+{
+	stop_serving = 1; 
+	return; 
+}
+
+Decoded_Frame_Cache::Decoded_Frame_Cache()
+{
+	capacity = 0; 
+	used = 0; 
+	hits = 0; 
+	misses = 0; 
+	return; 
+}
+
+void Decoded_Frame_Cache::set_capacity( uint64_t bytes )
+{
+	capacity = bytes; 
+	while( used > capacity )
+	{
+		used -= entries.back().bytes; 
+		lookup.erase( entries.back().key ); 
+		entries.pop_back(); 
+	}
+	return; 
+}
+
+Shared_Cell_Data Decoded_Frame_Cache::find( std::string key )
+{
+	auto found = lookup.find( key ); 
+	if( found == lookup.end() )
+	{
+		misses++; 
+		return Shared_Cell_Data(); 
+	}
+	hits++; 
+	entries.splice( entries.begin() , entries , found->second ); 
+	return found->second->MAT; 
+}
+
+void Decoded_Frame_Cache::insert( std::string key , Shared_Cell_Data MAT )
+{
+	uint64_t bytes = 0; 
+	for( unsigned int i=0 ; i < MAT->size() ; i++ )
+	{ bytes += (*MAT)[i].capacity() * sizeof(cell_real); }
+	if( bytes > capacity || lookup.count( key ) > 0 )
+	{ return; }
+	
+	// evict the least recently used frames until this one fits 
+	while( used + bytes > capacity )
+	{
+		used -= entries.back().bytes; 
+		lookup.erase( entries.back().key ); 
+		entries.pop_back(); 
+	}
+	entries.push_front( Entry{ key , MAT , bytes } ); 
+	lookup[key] = entries.begin(); 
+	used += bytes; 
+	return; 
+}
+
+void Decoded_Frame_Cache::display( std::ostream& os )
+{
+	os << entries.size() << " frames, " << used / 1048576.0 << " of " << capacity / 1048576.0 << " MB; " 
+		<< hits << " hits, " << misses << " misses"; 
+	return; 
+}
+
+static Decoded_Frame_Cache decoded_frames; 
+
+static bool send_all( int client , const char* data , size_t size )
+{
+	while( size > 0 )
+	{
+		ssize_t sent = send( client , data , size , MSG_NOSIGNAL ); 
+		if( sent < 0 && errno == EINTR )
+		{ continue; }
+		if( sent <= 0 )
+		{ return false; }
+		data += sent; 
+		size -= sent; 
+	}
+	return true; 
+}
+
+static bool reply( int client , std::string line )
+{
+	line += "\n"; 
+	return send_all( client , line.data() , line.size() ); 
+}
+
+// apply name=value to options and the camera; false if name is unknown 
+static bool apply_override( std::string name , double value )
+{
+	if( name == "camera_distance" )
+	{ options.camera_distance = value; }
+	else if( name == "camera_theta" )
+	{ options.camera_theta = value; }
+	else if( name == "camera_phi" )
+	{ options.camera_phi = value; }
+	else if( name == "nuclear_offset" )
+	{ options.nuclear_offset = value; }
+	else if( name == "cell_bound" )
+	{ options.cell_bound = value; }
+	else
+	{ return false; }
+	default_POV_options.set_camera_from_spherical_location( options.camera_distance , options.camera_theta , options.camera_phi ); 
+	return true; 
+}
+
+static void render_request( std::vector<std::string>& words , int client )
+{
+	if( words.size() < 2 )
+	{
+		reply( client , "error usage: render SNAPSHOT [OUTPUT] [name=value ...]" ); 
+		return; 
+	}
+	double start_time = omp_get_wtime(); 
+	
+	std::string filename = find_snapshot_file( words[1] ); 
+	struct stat file_info; 
+	if( stat( filename.c_str() , &file_info ) != 0 )
+	{
+		reply( client , "error cannot find " + words[1] ); 
+		return; 
+	}
+	
+	std::string output = ""; 
+	unsigned int first_override = 2; 
+	if( words.size() > 2 && words[2].find( '=' ) == std::string::npos )
+	{
+		output = words[2]; 
+		first_override = 3; 
+	}
+	if( output.size() == 0 )
+	{
+		size_t slash = words[1].find_last_of( '/' ); 
+		int index = snapshot_index( slash == std::string::npos ? words[1] : words[1].substr( slash+1 ) ); 
+		if( index < 0 )
+		{
+			reply( client , "error name an OUTPUT for " + words[1] ); 
+			return; 
+		}
+		output = create_output_filename( index ); 
+	}
+	
+	// overrides last for this request only 
+	Options saved_options = options; 
+	POV_Options saved_POV_options = default_POV_options; 
+	for( unsigned int i = first_override ; i < words.size() ; i++ )
+	{
+		size_t equals = words[i].find( '=' ); 
+		char* end = NULL; 
+		double value = equals == std::string::npos ? 0.0 : strtod( words[i].c_str() + equals + 1 , &end ); 
+		if( equals == std::string::npos || end == words[i].c_str() + equals + 1 || 
+			apply_override( words[i].substr( 0 , equals ) , value ) == false )
+		{
+			options = saved_options; 
+			default_POV_options = saved_POV_options; 
+			reply( client , "error unknown setting " + words[i] ); 
+			return; 
+		}
+	}
+	
+	char key [64]; 
+	snprintf( key , sizeof(key) , " %lld %lld.%09ld" , (long long) file_info.st_size , 
+		(long long) file_info.st_mtim.tv_sec , (long) file_info.st_mtim.tv_nsec ); 
+	Shared_Cell_Data MAT = decoded_frames.find( filename + key ); 
+	bool cached = (bool) MAT; 
+	
+	Frame_Buffers& buffers = thread_frame_buffers(); 
+	buffers.output.reset(); 
+	std::ostream os( &buffers.output ); 
+	bool read_ok = true; 
+	
+	// decode and write on the (warm) team of threads 
+	#pragma omp parallel 
+	#pragma omp single 
+	{
+		if( cached == false )
+		{
+			MAT.reset( new std::vector<std::vector<cell_real>> ); 
+			read_ok = read_snapshot_file( filename , *MAT , options.threads ); 
+		}
+		if( read_ok )
+		{ write_frame( os , *MAT ); }
+	}
+	options = saved_options; 
+	default_POV_options = saved_POV_options; 
+	
+	if( read_ok == false || MAT->size() == 0 )
+	{
+		reply( client , "error cannot read " + filename ); 
+		return; 
+	}
+	if( cached == false )
+	{ decoded_frames.insert( filename + key , MAT ); }
+	reply( client , "read " + std::to_string( (*MAT)[0].size() ) + " cells " + ( cached ? "(cached)" : "(decoded)" ) ); 
+	
+	if( output == "-" )
+	{
+		// the scene itself, back to the client 
+		reply( client , "scene " + std::to_string( buffers.output.size() ) ); 
+		send_all( client , buffers.output.data() , buffers.output.size() ); 
+	}
+	else if( buffers.output.write( output ) == false )
+	{
+		reply( client , "error could not write " + output ); 
+		return; 
+	}
+	std::ostringstream done; 
+	done << "done " << output << " " << buffers.output.size() << " " << omp_get_wtime() - start_time; 
+	reply( client , done.str() ); 
+	return; 
+}
+
+// false when the server should stop 
+static bool serve_client( int client , std::ostream& os )
+{
+	std::string pending = ""; 
+	char data [4096]; 
+	while( stop_serving == 0 )
+	{
+		ssize_t length = recv( client , data , sizeof(data) , 0 ); 
+		if( length < 0 && errno == EINTR )
+		{ continue; }
+		if( length <= 0 )
+		{ return true; }
+		pending.append( data , length ); 
+		
+		size_t end; 
+		while( ( end = pending.find( '\n' ) ) != std::string::npos )
+		{
+			std::istringstream line( pending.substr( 0 , end ) ); 
+			pending.erase( 0 , end+1 ); 
+			std::vector<std::string> words; 
+			std::string word; 
+			while( line >> word )
+			{ words.push_back( word ); }
+			if( words.size() == 0 )
+			{ continue; }
+			
+			if( words[0] == "render" )
+			{ render_request( words , client ); }
+			else if( words[0] == "stats" )
+			{
+				std::ostringstream stats; 
+				decoded_frames.display( stats ); 
+				reply( client , stats.str() ); 
+			}
+			else if( words[0] == "ping" )
+			{ reply( client , "pong" ); }
+			else if( words[0] == "quit" )
+			{ return true; }
+			else if( words[0] == "shutdown" )
+			{
+				reply( client , "bye" ); 
+				return false; 
+			}
+			else
+			{ reply( client , "error unknown request " + words[0] ); }
+		}
+	}
+	return false; 
+}
+
+bool run_render_server( std::string socket_path , std::ostream& os )
+{
+	struct sockaddr_un address; 
+	memset( &address , 0 , sizeof(address) ); 
+	address.sun_family = AF_UNIX; 
+	if( socket_path.size() >= sizeof(address.sun_path) )
+	{
+		os << "Error: socket path " << socket_path << " is too long!" << std::endl; 
+		return false; 
+	}
+	strcpy( address.sun_path , socket_path.c_str() ); 
+	
+	int server = socket( AF_UNIX , SOCK_STREAM | SOCK_CLOEXEC , 0 ); 
+	unlink( socket_path.c_str() ); 
+	if( server < 0 || bind( server , (struct sockaddr*) &address , sizeof(address) ) != 0 || listen( server , 16 ) != 0 )
+	{
+		os << "Error: could not listen on " << socket_path << "!" << std::endl; 
+		if( server >= 0 )
+		{ close( server ); }
+		return false; 
+	}
+	decoded_frames.set_capacity( (uint64_t) ( options.server_cache * 1048576.0 ) ); 
+	
+	struct sigaction action; 
+	memset( &action , 0 , sizeof(action) ); 
+	action.sa_handler = handle_stop_signal; 
+	sigaction( SIGINT , &action , NULL ); 
+	sigaction( SIGTERM , &action , NULL ); 
+	
+	os << "Serving on " << socket_path << " (Ctrl-C or \"shutdown\" to stop) ... " << std::endl; 
+	
+	// one connection at a time; a client may send many requests 
+	struct pollfd listening; 
+	listening.fd = server; 
+	listening.events = POLLIN; 
+	bool serving = true; 
+	while( serving && stop_serving == 0 )
+	{
+		if( poll( &listening , 1 , 250 ) <= 0 )
+		{ continue; }
+		int client = accept4( server , NULL , NULL , SOCK_CLOEXEC ); 
+		if( client < 0 )
+		{ continue; }
+		serving = serve_client( client , os ); 
+		close( client ); 
+	}
+	
+	close( server ); 
+	unlink( socket_path.c_str() ); 
+	signal( SIGINT , SIG_DFL ); 
+	signal( SIGTERM , SIG_DFL ); 
+	os << "Stopped serving: "; 
+	decoded_frames.display( os ); 
+	os << "." << std::endl; 
+	return true; 
+}
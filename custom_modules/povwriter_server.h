@@ -0,0 +1,129 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_server_h__
+#define __povwriter_server_h__
+
+#include <string>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+#include "./povwriter.h" 
+
+// Server mode keeps one povwriter running on a Unix domain socket, so a 
+// request costs no config parsing, splash, or thread start-up. Requests 
+// are lines of text; each gets status lines back: 
+// 
+//   render SNAPSHOT [OUTPUT] [name=value ...] 
+//     render SNAPSHOT (a .mat path, or its .mat.gz / .mat.zst) to OUTPUT 
+//     (default: povNNNNNNNN.pov from the snapshot's index). The values 
+//     camera_distance, camera_theta, camera_phi, nuclear_offset, and 
+//     cell_bound override the config for this request only. Replies 
+//     "read CELLS cells (cached|decoded)", then "done OUTPUT BYTES SECONDS" 
+//     or "error MESSAGE". With OUTPUT "-", the scene comes back on the 
+//     socket: "scene BYTES", then BYTES bytes of scene, then "done". 
+//   stats      reply with the decoded frame cache's use and hit rate 
+//   ping       reply "pong" 
+//   quit       close this connection 
+//   shutdown   stop the server 
+// 
+// Decoded frames are kept in an LRU cache (<server_cache> MB), keyed by 
+// path, size, and modification time, so re-renders of a frame with other 
+// settings skip the read and decode. 
+
+typedef std::shared_ptr< std::vector<std::vector<cell_real>> > Shared_Cell_Data; 
+
+class Decoded_Frame_Cache
+{
+ private:
+	struct Entry
+	{
+		std::string key; 
+		Shared_Cell_Data MAT; 
+		uint64_t bytes; 
+	}; 
+	std::list<Entry> entries; // most recently used first 
+	std::unordered_map< std::string , std::list<Entry>::iterator > lookup; 
+	uint64_t capacity; 
+	uint64_t used; 
+	uint64_t hits; 
+	uint64_t misses; 
+ public:
+	Decoded_Frame_Cache(); 
+	
+	void set_capacity( uint64_t bytes ); 
+	Shared_Cell_Data find( std::string key ); // NULL if absent 
+	void insert( std::string key , Shared_Cell_Data MAT ); 
+	void display( std::ostream& os ); 
+}; 
+
+// serve requests on socket_path until "shutdown", SIGINT, or SIGTERM 
+bool run_render_server( std::string socket_path , std::ostream& os ); 
+
+#endif 
@@ -0,0 +1,314 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_shm.h" 
+#include "povwriter_buffers.h" 
+
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static volatile sig_atomic_t stop_consuming = 0; 
+
+static void handle_stop_signal( int signal )
+{
+	stop_consuming = 1; 
+	return; 
+}
+
+static size_t slot_header_bytes( void )
+{ return 64; } // one cache line, so rows stay aligned 
+
+static Snapshot_Slot_Header* ring_slot( Snapshot_Ring_Header* header , uint64_t frame )
+{
+	char* first = (char*) header + slot_header_bytes(); 
+	return (Snapshot_Slot_Header*) ( first + ( frame % header->slots ) * header->slot_bytes ); 
+}
+
+static double* slot_row( Snapshot_Ring_Header* header , Snapshot_Slot_Header* slot , unsigned int row )
+{ return (double*) ( (char*) slot + slot_header_bytes() ) + row * header->max_cells; }
+
+Snapshot_Publisher::Snapshot_Publisher()
+{
+	name = ""; 
+	header = NULL; 
+	bytes = 0; 
+	return; 
+}
+
+bool Snapshot_Publisher::create( std::string name_in , int slots , int max_cells , int rows )
+{
+	name = name_in; 
+	if( slots < 1 || max_cells < 1 || rows < 1 )
+	{
+		std::cout << "Error: a snapshot ring needs at least one slot, cell, and row!" << std::endl; 
+		return false; 
+	}
+	uint64_t slot_bytes = slot_header_bytes() + (uint64_t) rows * max_cells * sizeof(double); 
+	slot_bytes = ( slot_bytes + 63 ) / 64 * 64; 
+	bytes = slot_header_bytes() + (uint64_t) slots * slot_bytes; 
+	
+	shm_unlink( name.c_str() ); 
+	int fd = shm_open( name.c_str() , O_CREAT | O_RDWR , 0600 ); 
+	if( fd < 0 || ftruncate( fd , bytes ) != 0 )
+	{
+		std::cout << "Error: could not create shared memory " << name << "!" << std::endl; 
+		if( fd >= 0 )
+		{ ::close( fd ); }
+		return false; 
+	}
+	void* memory = mmap( NULL , bytes , PROT_READ | PROT_WRITE , MAP_SHARED , fd , 0 ); 
+	::close( fd ); 
+	if( memory == MAP_FAILED )
+	{ return false; }
+	
+	// the new memory is zero: no frame published, every sequence even 
+	header = (Snapshot_Ring_Header*) memory; 
+	header->slots = slots; 
+	header->rows = rows; 
+	header->max_cells = max_cells; 
+	header->slot_bytes = slot_bytes; 
+	header->published.store( 0 ); 
+	header->closed.store( 0 ); 
+	std::atomic_thread_fence( std::memory_order_release ); 
+	header->magic = snapshot_ring_magic; 
+	return true; 
+}
+
+bool Snapshot_Publisher::publish( int index , POV_Frame_Columns& columns )
+{
+	if( header == NULL || columns.cells > (int) header->max_cells )
+	{ return false; }
+	
+	uint64_t frame = header->published.load( std::memory_order_relaxed ); 
+	Snapshot_Slot_Header* slot = ring_slot( header , frame ); 
+	slot->sequence.store( 2*frame+1 , std::memory_order_relaxed ); 
+	std::atomic_thread_fence( std::memory_order_release ); 
+	
+	slot->index = index; 
+	slot->cells = columns.cells; 
+	for( unsigned int row=0 ; row < header->rows ; row++ )
+	{
+		double* destination = slot_row( header , slot , row ); 
+		const double* source = row < columns.values.size() ? columns.values[row] : NULL; 
+		int stride = row < columns.strides.size() ? columns.strides[row] : 1; 
+		if( source == NULL )
+		{ memset( destination , 0 , columns.cells * sizeof(double) ); }
+		else if( stride == 1 )
+		{ memcpy( destination , source , columns.cells * sizeof(double) ); }
+		else
+		{
+			for( int i=0 ; i < columns.cells ; i++ )
+			{ destination[i] = source[ stride*i ]; }
+		}
+	}
+	
+	slot->sequence.store( 2*frame+2 , std::memory_order_release ); 
+	header->published.store( frame+1 , std::memory_order_release ); 
+	return true; 
+}
+
+void Snapshot_Publisher::close( void )
+{
+	if( header == NULL )
+	{ return; }
+	header->closed.store( 1 , std::memory_order_release ); 
+	munmap( header , bytes ); 
+	header = NULL; 
+	return; 
+}
+
+// copy frame out of its slot; false if it was (or is being) overwritten 
+static bool copy_frame( Snapshot_Ring_Header* header , uint64_t frame , int* index , std::vector<std::vector<cell_real>>& MAT )
+{
+	Snapshot_Slot_Header* slot = ring_slot( header , frame ); 
+	uint64_t sequence = slot->sequence.load( std::memory_order_acquire ); 
+	if( sequence != 2*frame+2 )
+	{ return false; }
+	
+	*index = (int) slot->index; 
+	uint64_t cells = slot->cells; 
+	if( cells > header->max_cells )
+	{ return false; }
+	resize_matlab_output( MAT , header->rows , cells ); 
+	for( unsigned int row=0 ; row < header->rows ; row++ )
+	{
+		const double* source = slot_row( header , slot , row ); 
+		for( uint64_t i=0 ; i < cells ; i++ )
+		{ MAT[row][i] = (cell_real) source[i]; }
+	}
+	
+	std::atomic_thread_fence( std::memory_order_acquire ); 
+	return slot->sequence.load( std::memory_order_relaxed ) == sequence; 
+}
+
+bool run_shared_memory_consumer( std::string name , std::ostream& os )
+{
+	int fd = shm_open( name.c_str() , O_RDONLY , 0 ); 
+	struct stat info; 
+	if( fd < 0 || fstat( fd , &info ) != 0 || info.st_size < (off_t) sizeof(Snapshot_Ring_Header) )
+	{
+		os << "Error: could not open shared memory " << name << "!" << std::endl; 
+		if( fd >= 0 )
+		{ close( fd ); }
+		return false; 
+	}
+	void* memory = mmap( NULL , info.st_size , PROT_READ , MAP_SHARED , fd , 0 ); 
+	close( fd ); 
+	Snapshot_Ring_Header* header = (Snapshot_Ring_Header*) memory; 
+	
+	// a forged or corrupt header must not size anything past the mapping: 
+	// each slot holds rows x max_cells doubles (checked by division, so 
+	// the product cannot overflow), and all slots fit in the file 
+	if( memory == MAP_FAILED || header->magic != snapshot_ring_magic || 
+		header->slots == 0 || header->rows == 0 || header->max_cells == 0 || 
+		header->slot_bytes < slot_header_bytes() || 
+		( header->slot_bytes - slot_header_bytes() ) / sizeof(double) / header->rows < header->max_cells || 
+		header->slots > ( (uint64_t) info.st_size - slot_header_bytes() ) / header->slot_bytes )
+	{
+		os << "Error: " << name << " is not a povwriter snapshot ring!" << std::endl; 
+		if( memory != MAP_FAILED )
+		{ munmap( memory , info.st_size ); }
+		return false; 
+	}
+	
+	struct sigaction action; 
+	memset( &action , 0 , sizeof(action) ); 
+	action.sa_handler = handle_stop_signal; 
+	sigaction( SIGINT , &action , NULL ); 
+	sigaction( SIGTERM , &action , NULL ); 
+	
+	os << "Rendering frames published to " << name << " (" << header->slots << " slots of " 
+		<< header->max_cells << " cells) ... " << std::endl; 
+	
+	Frame_Buffers& buffers = thread_frame_buffers(); 
+	uint64_t next = 0; 
+	uint64_t rendered = 0; 
+	uint64_t dropped = 0; 
+	struct timespec nap = { 0 , 1000000 }; // 1 ms between checks while idle 
+	while( stop_consuming == 0 )
+	{
+		bool closed = header->closed.load( std::memory_order_acquire ) != 0; 
+		uint64_t published = header->published.load( std::memory_order_acquire ); 
+		if( next == published )
+		{
+			if( closed )
+			{ break; }
+			nanosleep( &nap , NULL ); 
+			continue; 
+		}
+		
+		// skip the frames already overwritten, and the one likely being 
+		// overwritten now (unless it is the only one) 
+		uint64_t kept = std::max( header->slots - 1 , 1u ); 
+		uint64_t oldest = published > kept ? published - kept : 0; 
+		if( next < oldest )
+		{
+			dropped += oldest - next; 
+			next = oldest; 
+		}
+		
+		int index; 
+		if( copy_frame( header , next , &index , buffers.MAT ) == false )
+		{
+			dropped++; 
+			next++; 
+			continue; 
+		}
+		next++; 
+		
+		std::string filename = create_output_filename( index ); 
+		buffers.output.open( filename ); 
+		std::ostream frame( &buffers.output ); 
+		#pragma omp parallel 
+		#pragma omp single 
+		write_frame( frame , buffers.MAT ); 
+		
+		if( buffers.output.close() )
+		{
+			os << "Wrote " << filename << " (" << buffers.MAT[0].size() << " cells)" << std::endl; 
+			rendered++; 
+		}
+		else
+		{ os << "Error: could not write " << filename << "!" << std::endl; }
+	}
+	
+	// the publisher is done with a closed ring, and now so are we 
+	if( header->closed.load( std::memory_order_acquire ) != 0 && stop_consuming == 0 )
+	{ shm_unlink( name.c_str() ); }
+	munmap( memory , info.st_size ); 
+	signal( SIGINT , SIG_DFL ); 
+	signal( SIGTERM , SIG_DFL ); 
+	os << "Rendered " << rendered << " frames from " << name << "; dropped " << dropped 
+		<< " that were overwritten before they could be rendered." << std::endl; 
+	return true; 
+}
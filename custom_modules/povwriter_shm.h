@@ -0,0 +1,138 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_shm_h__
+#define __povwriter_shm_h__
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+#include "./povwriter.h" 
+#include "./povwriter_insitu.h" 
+
+// Shared-memory handoff: a simulation in another process publishes each 
+// frame's columns into a POSIX shared-memory ring of slots, and 
+// "povwriter --shm NAME" renders them as they arrive. 
+// 
+// Each slot holds one frame in the layout of the cell matrix (row r of 
+// the frame is max_cells doubles at r*max_cells) behind a seqlock: the 
+// slot's sequence is odd while frame f is being written (2f+1) and 2f+2 
+// once it is complete. The publisher never waits: it always writes the 
+// next slot, overwriting the oldest frame. The consumer renders the oldest 
+// frame not yet overwritten, copying it out and checking that the sequence 
+// did not change meanwhile. So a slow renderer drops frames (and catches 
+// up to the newest ones) rather than slowing the simulation; with one slot, 
+// it always renders the latest frame. 
+// 
+// The copy is what makes the check possible: a frame read in place could 
+// be overwritten while it renders. It is a plain copy of each row into the 
+// consumer's reused cell data, far cheaper than the render. 
+
+static const uint64_t snapshot_ring_magic = 0x31676e6972766f70ull; // "povring1" 
+
+struct Snapshot_Ring_Header
+{
+	uint64_t magic; 
+	uint32_t slots; 
+	uint32_t rows; 
+	uint64_t max_cells; 
+	uint64_t slot_bytes; // slot header and rows 
+	std::atomic<uint64_t> published; // frames published so far 
+	std::atomic<uint32_t> closed; // no more frames will come 
+}; 
+
+struct Snapshot_Slot_Header
+{
+	std::atomic<uint64_t> sequence; 
+	int64_t index; 
+	uint64_t cells; 
+}; 
+
+// for the simulation (in libpovwriter.a) 
+class POVWRITER_API Snapshot_Publisher
+{
+ private:
+	std::string name; 
+	Snapshot_Ring_Header* header; 
+	size_t bytes; 
+ public:
+	Snapshot_Publisher(); 
+	
+	// create (or replace) the ring NAME ( e.g. "/povwriter" ) 
+	bool create( std::string name , int slots , int max_cells , int rows = 33 ); 
+	// copy the columns into the next slot; false if too large 
+	bool publish( int index , POV_Frame_Columns& columns ); 
+	// tell the consumer that no more frames will come, and unmap 
+	void close( void ); 
+}; 
+
+// render the frames published to ring NAME until it is closed and drained 
+// (then remove it), or SIGINT / SIGTERM 
+bool run_shared_memory_consumer( std::string name , std::ostream& os ); 
+
+#endif 
@@ -0,0 +1,336 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_tar.h" 
+#include "povwriter_compressed.h" 
+
+#include <fcntl.h>
+#include <unistd.h>
+
+Tar_Archive tar_archive; 
+
+static const size_t tar_block_size = 512; 
+
+// numeric fields are octal text, or (for large sizes) big-endian 
+// base-256 with the high bit of the first byte set 
+
+static uint64_t tar_number( const char* field , size_t length )
+{
+	uint64_t value = 0; 
+	if( (unsigned char) field[0] & 0x80 )
+	{
+		for( size_t k=1; k < length ; k++ )
+		{ value = ( value << 8 ) | (unsigned char) field[k]; }
+		return value; 
+	}
+	for( size_t k=0; k < length && field[k] ; k++ )
+	{
+		if( field[k] >= '0' && field[k] <= '7' )
+		{ value = ( value << 3 ) + ( field[k] - '0' ); }
+	}
+	return value; 
+}
+
+static std::string tar_string( const char* field , size_t length )
+{
+	size_t n = 0; 
+	while( n < length && field[n] )
+	{ n++; }
+	return std::string( field , n ); 
+}
+
+// "./output/x.mat" and "output/x.mat" are the same path 
+
+static std::string normalize_path( std::string path )
+{
+	while( path.compare( 0 , 2 , "./" ) == 0 )
+	{ path = path.substr( 2 ); }
+	return path; 
+}
+
+static std::string file_name( std::string path )
+{
+	size_t slash = path.find_last_of( '/' ); 
+	if( slash == std::string::npos )
+	{ return path; }
+	return path.substr( slash+1 ); 
+}
+
+static bool pread_all( int fd , void* buffer , size_t size , off_t offset )
+{
+	size_t done = 0; 
+	while( done < size )
+	{
+		ssize_t result = pread( fd , (char*) buffer + done , size - done , offset + done ); 
+		if( result <= 0 )
+		{ return false; }
+		done += result; 
+	}
+	return true; 
+}
+
+Tar_Archive::Tar_Archive()
+{
+	fd = -1; 
+	filename = ""; 
+	return; 
+}
+
+Tar_Archive::~Tar_Archive()
+{
+	close(); 
+	return; 
+}
+
+bool Tar_Archive::is_open( void )
+{ return fd >= 0; }
+
+void Tar_Archive::close( void )
+{
+	if( fd >= 0 )
+	{ ::close( fd ); }
+	fd = -1; 
+	members.clear(); 
+	members_by_name.clear(); 
+	return; 
+}
+
+bool Tar_Archive::open( std::string filename_in )
+{
+	close(); 
+	filename = filename_in; 
+	fd = ::open( filename.c_str() , O_RDONLY ); 
+	if( fd < 0 )
+	{
+		std::cout << "Error: could not open tar archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	// walk the headers 
+	
+	char header [tar_block_size]; 
+	uint64_t offset = 0; 
+	std::string long_name = ""; // from a GNU 'L' or pax 'x' entry 
+	uint64_t long_size = 0; // from a pax 'x' entry 
+	std::vector<std::string> duplicate_names; 
+	
+	while( pread_all( fd , header , tar_block_size , offset ) )
+	{
+		// two zero blocks end the archive 
+		if( header[0] == '\0' )
+		{ break; }
+		
+		Tar_Member member; 
+		member.offset = offset + tar_block_size; 
+		member.size = tar_number( header + 124 , 12 ); 
+		char type = header[156]; 
+		offset = member.offset + ( ( member.size + tar_block_size - 1 ) / tar_block_size ) * tar_block_size; 
+		
+		if( type == 'L' || type == 'x' )
+		{
+			std::vector<char> data( member.size + 1 , '\0' ); 
+			if( pread_all( fd , data.data() , member.size , member.offset ) == false )
+			{ break; }
+			
+			if( type == 'L' )
+			{ long_name = data.data(); }
+			else
+			{
+				// pax records: "length key=value\n" 
+				size_t k = 0; 
+				while( k < member.size )
+				{
+					size_t length = strtoul( data.data() + k , NULL , 10 ); 
+					if( length == 0 || k + length > member.size )
+					{ break; }
+					std::string record( data.data() + k , length - 1 ); 
+					size_t space = record.find( ' ' ); 
+					size_t equals = record.find( '=' ); 
+					if( space != std::string::npos && equals != std::string::npos )
+					{
+						std::string key = record.substr( space+1 , equals-space-1 ); 
+						std::string value = record.substr( equals+1 ); 
+						if( key == "path" )
+						{ long_name = value; }
+						if( key == "size" )
+						{ long_size = strtoull( value.c_str() , NULL , 10 ); }
+					}
+					k += length; 
+				}
+			}
+			continue; 
+		}
+		
+		if( long_size > 0 )
+		{
+			member.size = long_size; 
+			offset = member.offset + ( ( member.size + tar_block_size - 1 ) / tar_block_size ) * tar_block_size; 
+		}
+		
+		std::string path = long_name; 
+		if( path.size() == 0 )
+		{
+			path = tar_string( header , 100 ); 
+			if( memcmp( header + 257 , "ustar" , 5 ) == 0 && header[345] )
+			{ path = tar_string( header + 345 , 155 ) + "/" + path; }
+		}
+		long_name = ""; 
+		long_size = 0; 
+		
+		// regular files only 
+		if( type != '0' && type != '\0' && type != '7' )
+		{ continue; }
+		
+		path = normalize_path( path ); 
+		members[path] = member; 
+		
+		std::string name = file_name( path ); 
+		if( members_by_name.find( name ) != members_by_name.end() )
+		{ duplicate_names.push_back( name ); }
+		members_by_name[name] = member; 
+	}
+	
+	// a file name found in several folders can only be found by its path 
+	for( unsigned int k=0; k < duplicate_names.size() ; k++ )
+	{ members_by_name.erase( duplicate_names[k] ); }
+	
+	std::cout << "Indexed " << members.size() << " files in tar archive " << filename << " ... " << std::endl; 
+	return true; 
+}
+
+bool Tar_Archive::find( std::string path , Tar_Member& member )
+{
+	std::unordered_map<std::string,Tar_Member>::iterator it = members.find( normalize_path( path ) ); 
+	if( it != members.end() )
+	{
+		member = it->second; 
+		return true; 
+	}
+	it = members_by_name.find( file_name( path ) ); 
+	if( it != members_by_name.end() )
+	{
+		member = it->second; 
+		return true; 
+	}
+	return false; 
+}
+
+bool Tar_Archive::matlab_dimensions( std::string path , uint64_t* rows , uint64_t* cells )
+{
+	Tar_Member member; 
+	unsigned int header[5]; 
+	if( find( path , member ) == false || member.size < 20 || 
+		pread_all( fd , (char*) header , 20 , member.offset ) == false )
+	{ return false; }
+	*rows = header[1]; 
+	*cells = header[2]; 
+	return true; 
+}
+
+bool Tar_Archive::read_matlab( std::string path , std::vector<std::vector<cell_real>>& MAT )
+{
+	Tar_Member member; 
+	if( find( path , member ) == false )
+	{
+		std::cout << "Error: " << path << " is not in tar archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	// stream the member's bytes into the decoder 
+	
+	Matlab_Stream_Decoder decoder( MAT ); 
+	std::vector<char> buffer( 1<<22 ); 
+	uint64_t done = 0; 
+	while( done < member.size )
+	{
+		size_t size = buffer.size(); 
+		if( member.size - done < size )
+		{ size = member.size - done; }
+		if( pread_all( fd , buffer.data() , size , member.offset + done ) == false || 
+			decoder.add( buffer.data() , size ) == false )
+		{ break; }
+		done += size; 
+	}
+	
+	if( decoder.complete() == false )
+	{
+		std::cout << "Error: could not read " << path << " from tar archive " << filename << "!" << std::endl; 
+		return false; 
+	}
+	return true; 
+}
+
+void Tar_Archive::prefetch( std::string path )
+{
+	Tar_Member member; 
+	if( find( path , member ) == false )
+	{ return; }
+	#ifdef POSIX_FADV_WILLNEED
+	posix_fadvise( fd , member.offset , member.size , POSIX_FADV_WILLNEED ); 
+	#endif 
+	return; 
+}
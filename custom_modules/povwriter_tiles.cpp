@@ -0,0 +1,266 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_tiles.h" 
+#include "povwriter_journal.h" 
+
+#include <sstream>
+#include <algorithm>
+
+static const double tile_pixel_margin = 1.0; 
+
+static std::vector<double> cross( const std::vector<double>& u , const std::vector<double>& v )
+{ return { u[1]*v[2]-u[2]*v[1] , u[2]*v[0]-u[0]*v[2] , u[0]*v[1]-u[1]*v[0] }; }
+
+static double dot( const std::vector<double>& u , const std::vector<double>& v )
+{ return u[0]*v[0] + u[1]*v[1] + u[2]*v[2]; }
+
+std::vector<Tile> tile_grid( void )
+{
+	std::vector<Tile> tiles; 
+	int columns = std::max( options.tile_columns , 1 ); 
+	int rows = std::max( options.tile_rows , 1 ); 
+	for( int r=0 ; r < rows ; r++ )
+	{
+		for( int c=0 ; c < columns ; c++ )
+		{
+			Tile tile; 
+			tile.row = r; 
+			tile.column = c; 
+			tile.first_column = c * options.image_width / columns + 1; 
+			tile.last_column = (c+1) * options.image_width / columns; 
+			tile.first_row = r * options.image_height / rows + 1; 
+			tile.last_row = (r+1) * options.image_height / rows; 
+			tiles.push_back( tile ); 
+		}
+	}
+	return tiles; 
+}
+
+void cull_cells_for_tile( std::vector<std::vector<cell_real>>& MAT , Tile& tile , std::vector<char>& keep )
+{
+	POV_Options& camera = default_POV_options; 
+	std::vector<double> location = camera.camera_position; 
+	std::vector<double> look = camera.camera_look_at - location; 
+	std::vector<double> direction = normalize( look ); 
+	
+	// the tile's image coordinates: x0 = x/width - 1/2 , and 
+	// y0 = ( height-1-y )/height - 1/2 , for pixels x , y from 0 
+	double width = options.image_width; 
+	double height = options.image_height; 
+	double x0 [2] = { ( tile.first_column - 1 - tile_pixel_margin ) / width - 0.5 , 
+		( tile.last_column + tile_pixel_margin ) / width - 0.5 }; 
+	double y0 [2] = { ( height - tile.last_row - tile_pixel_margin ) / height - 0.5 , 
+		( height + 1 - tile.first_row + tile_pixel_margin ) / height - 0.5 }; 
+	
+	std::vector<double> corner [2][2]; 
+	for( int i=0 ; i < 2 ; i++ )
+	{
+		for( int j=0 ; j < 2 ; j++ )
+		{ corner[i][j] = direction + x0[i] * camera.camera_right + y0[j] * camera.camera_up; }
+	}
+	std::vector<double> middle = 0.25 * ( corner[0][0] + corner[0][1] + corner[1][0] + corner[1][1] ); 
+	
+	// left, right, bottom, and top planes, with normals into the frustum 
+	std::vector<double> planes [4] = { cross( corner[0][0] , corner[0][1] ) , cross( corner[1][0] , corner[1][1] ) , 
+		cross( corner[0][0] , corner[1][0] ) , cross( corner[0][1] , corner[1][1] ) }; 
+	for( int k=0 ; k < 4 ; k++ )
+	{
+		normalize( &planes[k] ); 
+		if( dot( planes[k] , middle ) < 0.0 )
+		{ planes[k] = -1.0 * planes[k]; }
+	}
+	
+	int cells = MAT[0].size(); 
+	keep.assign( cells , 0 ); 
+	std::vector<double> radii( cells ); 
+	double low [3] = { 9e99 , 9e99 , 9e99 }; 
+	double high [3] = { -9e99 , -9e99 , -9e99 }; 
+	bool any = false; 
+	for( int i=0 ; i < cells ; i++ )
+	{
+		radii[i] = pow( 0.238732414637843 * MAT[4][i] , 0.33333333333333333333333333333 ); 
+		double p [3] = { MAT[1][i] - location[0] , MAT[2][i] - location[1] , MAT[3][i] - location[2] }; 
+		bool inside = true; 
+		for( int k=0 ; k < 4 && inside ; k++ )
+		{ inside = planes[k][0]*p[0] + planes[k][1]*p[1] + planes[k][2]*p[2] >= -radii[i]; }
+		if( inside == false )
+		{ continue; }
+		keep[i] = 1; 
+		any = true; 
+		for( int d=0 ; d < 3 ; d++ )
+		{
+			low[d] = std::min( low[d] , (double) MAT[1+d][i] - radii[i] ); 
+			high[d] = std::max( high[d] , (double) MAT[1+d][i] + radii[i] ); 
+		}
+	}
+	if( any == false || camera.no_shadow || options.tile_shadow_casters == false )
+	{ return; }
+	
+	// shadow casters: the pyramid from the light around the kept cells' 
+	// bounding box, in a basis looking from the light at the box 
+	std::vector<double> light = camera.light_position; 
+	std::vector<double> w = { 0.5*(low[0]+high[0]) - light[0] , 0.5*(low[1]+high[1]) - light[1] , 0.5*(low[2]+high[2]) - light[2] }; 
+	normalize( &w ); 
+	std::vector<double> u = fabs( w[0] ) < 0.9 ? cross( w , {1,0,0} ) : cross( w , {0,1,0} ); 
+	normalize( &u ); 
+	std::vector<double> v = cross( w , u ); 
+	
+	double u_range [2] = { 9e99 , -9e99 }; 
+	double v_range [2] = { 9e99 , -9e99 }; 
+	double farthest = 0.0; 
+	for( int k=0 ; k < 8 ; k++ )
+	{
+		std::vector<double> corner = { ( k & 1 ? high[0] : low[0] ) - light[0] , 
+			( k & 2 ? high[1] : low[1] ) - light[1] , ( k & 4 ? high[2] : low[2] ) - light[2] }; 
+		double depth = dot( corner , w ); 
+		// the light is in (or beside) the box: anything may cast a shadow 
+		if( depth <= 0.0 )
+		{
+			keep.assign( cells , 1 ); 
+			return; 
+		}
+		u_range[0] = std::min( u_range[0] , dot( corner , u ) / depth ); 
+		u_range[1] = std::max( u_range[1] , dot( corner , u ) / depth ); 
+		v_range[0] = std::min( v_range[0] , dot( corner , v ) / depth ); 
+		v_range[1] = std::max( v_range[1] , dot( corner , v ) / depth ); 
+		farthest = std::max( farthest , depth ); 
+	}
+	std::vector<double> inward = w + 0.5*(u_range[0]+u_range[1]) * u + 0.5*(v_range[0]+v_range[1]) * v; 
+	std::vector<double> shadow_planes [4] = { cross( w + u_range[0] * u , v ) , cross( w + u_range[1] * u , v ) , 
+		cross( w + v_range[0] * v , u ) , cross( w + v_range[1] * v , u ) }; 
+	for( int k=0 ; k < 4 ; k++ )
+	{
+		normalize( &shadow_planes[k] ); 
+		if( dot( shadow_planes[k] , inward ) < 0.0 )
+		{ shadow_planes[k] = -1.0 * shadow_planes[k]; }
+	}
+	
+	for( int i=0 ; i < cells ; i++ )
+	{
+		if( keep[i] )
+		{ continue; }
+		double p [3] = { MAT[1][i] - light[0] , MAT[2][i] - light[1] , MAT[3][i] - light[2] }; 
+		// beyond the kept cells, a cell cannot shadow them 
+		bool inside = p[0]*w[0] + p[1]*w[1] + p[2]*w[2] - radii[i] <= farthest; 
+		for( int k=0 ; k < 4 && inside ; k++ )
+		{ inside = shadow_planes[k][0]*p[0] + shadow_planes[k][1]*p[1] + shadow_planes[k][2]*p[2] >= -radii[i]; }
+		if( inside )
+		{ keep[i] = 1; }
+	}
+	return; 
+}
+
+// povNNNNNNNN.pov -> povNNNNNNNN_rR_cC.extension 
+static std::string tile_filename( int index , Tile& tile , std::string extension )
+{
+	std::string base = create_output_filename( index ); 
+	if( base.size() > 4 && base.compare( base.size()-4 , 4 , ".pov" ) == 0 )
+	{ base.resize( base.size()-4 ); }
+	return base + "_r" + std::to_string( tile.row ) + "_c" + std::to_string( tile.column ) + extension; 
+}
+
+bool write_frame_tiles( int index , std::vector<std::vector<cell_real>>& MAT , Frame_Output_Buffer& output , 
+	std::vector<std::string>& scenes )
+{
+	std::vector<Tile> tiles = tile_grid(); 
+	std::vector<char> keep; 
+	bool success = true; 
+	for( unsigned int t=0 ; t < tiles.size() ; t++ )
+	{
+		Tile& tile = tiles[t]; 
+		cull_cells_for_tile( MAT , tile , keep ); 
+		
+		std::string scene = tile_filename( index , tile , ".pov" ); 
+		output.open( scene ); 
+		std::ostream os( &output ); 
+		Write_POV_start( os ); 
+		plot_all_cells( os , MAT , &keep ); 
+		
+		std::ostringstream ini; 
+		ini << "; tile (row " << tile.row << ", column " << tile.column << ") of " << options.tile_rows << " x " 
+			<< options.tile_columns << ": " << std::count( keep.begin() , keep.end() , 1 ) << " of " << keep.size() << " cells" << std::endl 
+			<< "+I" << scene << std::endl 
+			<< "+O" << tile_filename( index , tile , ".png" ) << std::endl 
+			<< "+W" << options.image_width << std::endl 
+			<< "+H" << options.image_height << std::endl 
+			<< "+SC" << tile.first_column << std::endl 
+			<< "+EC" << tile.last_column << std::endl 
+			<< "+SR" << tile.first_row << std::endl 
+			<< "+ER" << tile.last_row << std::endl; 
+		std::string ini_text = ini.str(); 
+		
+		if( output.close() && write_output_file( tile_filename( index , tile , ".ini" ) , ini_text.data() , ini_text.size() ) )
+		{ scenes.push_back( scene ); }
+		else
+		{
+			std::cout << "Error: could not write " << scene << "!" << std::endl; 
+			success = false; 
+		}
+	}
+	return success; 
+}
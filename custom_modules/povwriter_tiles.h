@@ -0,0 +1,121 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __povwriter_tiles_h__
+#define __povwriter_tiles_h__
+
+#include <string>
+#include <vector>
+
+#include "./povwriter.h" 
+#include "./povwriter_buffers.h" 
+
+// Tiled output splits each frame's image into a grid of columns x rows 
+// tiles (<tiles>), and writes for each tile 
+// 
+//   povNNNNNNNN_rR_cC.pov   the scene, with only the cells that can show 
+//                           in the tile, or shadow one that does 
+//   povNNNNNNNN_rR_cC.ini   the image size, the tile's +SC/+EC/+SR/+ER 
+//                           bounds, and the scene and image names 
+// 
+// so that each tile parses only its own cells, and the tiles can render 
+// on different cores or machines and be stitched afterwards. 
+// 
+// The scene's camera sets right and up after look_at, so POV-Ray shoots 
+// the ray for image coordinates x0 , y0 in [-1/2,1/2] along 
+// direction + x0 * right + y0 * up (direction: the unit vector to look_at). 
+// Each tile's frustum is the four planes through the camera and the 
+// tile's edges (one pixel wider, for antialiasing), and a cell is kept if 
+// its sphere reaches inside all four. A cell outside the frustum is still 
+// kept if it reaches into the pyramid from the light around the kept 
+// cells' bounding box, where it could cast a shadow on them, unless 
+// shadow_casters="false": then tiles are smaller still, but shadows cast 
+// across a tile's edge are lost. 
+
+class Tile
+{
+ public:
+	int row; 
+	int column; 
+	// pixels, from 1, inclusive (POV-Ray's +SC, +EC, +SR, and +ER) 
+	int first_column; 
+	int last_column; 
+	int first_row; 
+	int last_row; 
+}; 
+
+std::vector<Tile> tile_grid( void ); 
+
+// keep[i] is nonzero for each cell i that the tile's scene needs 
+void cull_cells_for_tile( std::vector<std::vector<cell_real>>& MAT , Tile& tile , std::vector<char>& keep ); 
+
+// the frame's tile scenes and .ini files; scenes gets the names of the 
+// scenes written. False if any could not be written. 
+bool write_frame_tiles( int index , std::vector<std::vector<cell_real>>& MAT , Frame_Output_Buffer& output , 
+	std::vector<std::string>& scenes ); 
+
+#endif 
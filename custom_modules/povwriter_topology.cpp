@@ -0,0 +1,261 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_topology.h" 
+
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <sched.h>
+#include <omp.h>
+
+std::vector<int> affinity_cpus( void )
+{
+	std::vector<int> cpus; 
+	
+	// the mask can be larger than the default cpu_set_t 
+	for( int size = 1024 ; size <= 1<<20 ; size *= 2 )
+	{
+		cpu_set_t* mask = CPU_ALLOC( size ); 
+		size_t bytes = CPU_ALLOC_SIZE( size ); 
+		CPU_ZERO_S( bytes , mask ); 
+		if( sched_getaffinity( 0 , bytes , mask ) == 0 )
+		{
+			for( int cpu = 0 ; cpu < size ; cpu++ )
+			{
+				if( CPU_ISSET_S( cpu , bytes , mask ) )
+				{ cpus.push_back( cpu ); }
+			}
+			CPU_FREE( mask ); 
+			return cpus; 
+		}
+		CPU_FREE( mask ); 
+		if( errno != EINVAL )
+		{ break; }
+	}
+	return cpus; 
+}
+
+static bool read_first_line( std::string filename , std::string& line )
+{
+	std::ifstream file( filename.c_str() ); 
+	return (bool) std::getline( file , line ); 
+}
+
+// the quota in CPUs from one cgroup directory, or 0 
+static double cgroup_directory_quota( std::string directory , bool version2 )
+{
+	std::string line; 
+	if( version2 )
+	{
+		// "max 100000" or "QUOTA PERIOD" 
+		if( read_first_line( directory + "/cpu.max" , line ) == false )
+		{ return 0.0; }
+		std::istringstream stream( line ); 
+		std::string quota; 
+		double period = 0.0; 
+		stream >> quota >> period; 
+		if( quota == "max" || period <= 0.0 )
+		{ return 0.0; }
+		return atof( quota.c_str() ) / period; 
+	}
+	
+	std::string period; 
+	if( read_first_line( directory + "/cpu.cfs_quota_us" , line ) == false || 
+		read_first_line( directory + "/cpu.cfs_period_us" , period ) == false )
+	{ return 0.0; }
+	double quota = atof( line.c_str() ); // -1: no quota 
+	if( quota <= 0.0 || atof( period.c_str() ) <= 0.0 )
+	{ return 0.0; }
+	return quota / atof( period.c_str() ); 
+}
+
+// the tightest quota along the cgroup path (a parent's quota also limits 
+// its children). Inside a container, the cgroup is often mounted at its 
+// own root, so missing directories are skipped. 
+static double cgroup_path_quota( std::string mount , std::string path , bool version2 )
+{
+	double quota = 0.0; 
+	while( true )
+	{
+		double here = cgroup_directory_quota( mount + path , version2 ); 
+		if( here > 0.0 && ( quota == 0.0 || here < quota ) )
+		{ quota = here; }
+		if( path.size() <= 1 )
+		{ break; }
+		size_t slash = path.find_last_of( '/' ); 
+		path = ( slash == 0 || slash == std::string::npos ) ? "" : path.substr( 0 , slash ); 
+	}
+	return quota; 
+}
+
+double cgroup_cpu_quota( void )
+{
+	std::ifstream file( "/proc/self/cgroup" ); 
+	std::string line; 
+	double quota = 0.0; 
+	
+	// lines are "ID:CONTROLLERS:PATH"; v2 has ID 0 and no controllers 
+	while( std::getline( file , line ) )
+	{
+		size_t first = line.find( ':' ); 
+		size_t second = line.find( ':' , first + 1 ); 
+		if( first == std::string::npos || second == std::string::npos )
+		{ continue; }
+		std::string controllers = line.substr( first + 1 , second - first - 1 ); 
+		std::string path = line.substr( second + 1 ); 
+		
+		double here = 0.0; 
+		if( controllers == "" )
+		{
+			here = cgroup_path_quota( "/sys/fs/cgroup" , path , true ); 
+			if( here == 0.0 )
+			{ here = cgroup_path_quota( "/sys/fs/cgroup/unified" , path , true ); }
+		}
+		else if( ( "," + controllers + "," ).find( ",cpu," ) != std::string::npos )
+		{
+			here = cgroup_path_quota( "/sys/fs/cgroup/" + controllers , path , false ); 
+			if( here == 0.0 )
+			{ here = cgroup_path_quota( "/sys/fs/cgroup/cpu" , path , false ); }
+		}
+		if( here > 0.0 && ( quota == 0.0 || here < quota ) )
+		{ quota = here; }
+	}
+	return quota; 
+}
+
+int automatic_thread_count( std::ostream& os )
+{
+	std::vector<int> cpus = affinity_cpus(); 
+	double quota = cgroup_cpu_quota(); 
+	
+	int threads = cpus.size(); 
+	if( threads < 1 )
+	{ threads = omp_get_num_procs(); }
+	if( quota > 0.0 && (int) ceil( quota ) < threads )
+	{ threads = (int) ceil( quota ); }
+	if( threads < 1 )
+	{ threads = 1; }
+	
+	os << "\tthreads=\"auto\": " << cpus.size() << " CPUs in the affinity mask ("; 
+	for( unsigned int k=0; k < cpus.size() ; k++ )
+	{
+		// print ranges, e.g., 0-7,16-23 
+		unsigned int end = k; 
+		while( end+1 < cpus.size() && cpus[end+1] == cpus[end]+1 )
+		{ end++; }
+		os << ( k > 0 ? "," : "" ) << cpus[k]; 
+		if( end > k )
+		{ os << "-" << cpus[end]; }
+		k = end; 
+	}
+	os << "), "; 
+	if( quota > 0.0 )
+	{ os << "cgroup CPU quota " << quota << " CPUs"; }
+	else
+	{ os << "no cgroup CPU quota"; }
+	os << "; using " << threads << " threads" << std::endl; 
+	
+	return threads; 
+}
+
+bool pin_current_thread( int cpu )
+{
+	int size = cpu + 1 > 1024 ? cpu + 1 : 1024; 
+	cpu_set_t* mask = CPU_ALLOC( size ); 
+	size_t bytes = CPU_ALLOC_SIZE( size ); 
+	CPU_ZERO_S( bytes , mask ); 
+	CPU_SET_S( cpu , bytes , mask ); 
+	bool success = sched_setaffinity( 0 , bytes , mask ) == 0; 
+	CPU_FREE( mask ); 
+	return success; 
+}
+
+void pin_openmp_threads( int threads , std::ostream& os )
+{
+	std::vector<int> cpus = affinity_cpus(); 
+	if( cpus.size() == 0 )
+	{ return; }
+	std::vector<int> pinned( threads , -1 ); 
+	
+	#pragma omp parallel num_threads( threads )
+	{
+		int t = omp_get_thread_num(); 
+		int cpu = cpus[ t % cpus.size() ]; 
+		if( pin_current_thread( cpu ) )
+		{ pinned[t] = cpu; }
+	}
+	
+	os << "Pinned threads to CPUs:"; 
+	for( int t=0; t < threads ; t++ )
+	{ os << " " << t << "->" << pinned[t]; }
+	os << std::endl; 
+	if( (int) cpus.size() < threads )
+	{ os << "Warning: " << threads << " threads share " << cpus.size() << " CPUs!" << std::endl; }
+	return; 
+}
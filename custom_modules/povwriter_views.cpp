@@ -0,0 +1,118 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_views.h" 
+
+// povNNNNNNNN.pov -> povNNNNNNNN + suffix 
+static std::string view_filename( int index , std::string suffix )
+{
+	std::string base = create_output_filename( index ); 
+	if( base.size() > 4 && base.compare( base.size()-4 , 4 , ".pov" ) == 0 )
+	{ base.resize( base.size()-4 ); }
+	return base + suffix; 
+}
+
+bool write_frame_views( int index , std::vector<std::vector<cell_real>>& MAT , Frame_Output_Buffer& output , 
+	std::vector<std::string>& scenes , std::string& include )
+{
+	include = view_filename( index , ".inc" ); 
+	output.open( include ); 
+	std::ostream geometry( &output ); 
+	plot_all_cells( geometry , MAT ); 
+	if( output.close() == false )
+	{
+		std::cout << "Error: could not write " << include << "!" << std::endl; 
+		return false; 
+	}
+	size_t slash = include.find_last_of( '/' ); 
+	std::string include_name = slash == std::string::npos ? include : include.substr( slash+1 ); 
+	
+	// each camera's header, from a copy of the options (other frames may 
+	// be writing theirs at the same time) 
+	bool success = true; 
+	for( unsigned int k=0 ; k < options.cameras.size() ; k++ )
+	{
+		Camera_View& camera = options.cameras[k]; 
+		POV_Options view = default_POV_options; 
+		view.set_camera_from_spherical_location( camera.distance , camera.theta , camera.phi ); 
+		
+		std::string scene = view_filename( index , "_" + camera.name + ".pov" ); 
+		output.open( scene ); 
+		std::ostream os( &output ); 
+		Write_POV_start( view , os ); 
+		os << "#include \"" << include_name << "\"" << std::endl; 
+		
+		if( output.close() )
+		{ scenes.push_back( scene ); }
+		else
+		{
+			std::cout << "Error: could not write " << scene << "!" << std::endl; 
+			success = false; 
+		}
+	}
+	return success; 
+}
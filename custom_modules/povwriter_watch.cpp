@@ -0,0 +1,158 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "povwriter_watch.h" 
+
+#include <csignal>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+
+static volatile sig_atomic_t stop_watching = 0; 
+
+static void handle_stop_signal( int signal )
+{
+	stop_watching = 1; 
+	return; 
+}
+
+int snapshot_index( std::string name )
+{
+	std::string suffix = "_cells_physicell.mat"; 
+	size_t digits = options.filebase.size(); 
+	if( name.size() != digits + 8 + suffix.size() || 
+		name.compare( 0 , digits , options.filebase ) != 0 || 
+		name.compare( digits + 8 , std::string::npos , suffix ) != 0 )
+	{ return -1; }
+	
+	int index = 0; 
+	for( size_t i = digits ; i < digits + 8 ; i++ )
+	{
+		if( name[i] < '0' || name[i] > '9' )
+		{ return -1; }
+		index = 10*index + ( name[i] - '0' ); 
+	}
+	return index; 
+}
+
+bool watch_snapshots( std::function<void(int)> render , std::ostream& os )
+{
+	int fd = inotify_init1( IN_CLOEXEC ); 
+	if( fd < 0 || inotify_add_watch( fd , options.folder.c_str() , IN_CLOSE_WRITE | IN_MOVED_TO ) < 0 )
+	{
+		os << "Error: could not watch " << options.folder << "!" << std::endl; 
+		if( fd >= 0 )
+		{ close( fd ); }
+		return false; 
+	}
+	
+	// stop on Ctrl-C or kill, after the frames in progress are done 
+	struct sigaction action; 
+	memset( &action , 0 , sizeof(action) ); 
+	action.sa_handler = handle_stop_signal; 
+	sigaction( SIGINT , &action , NULL ); 
+	sigaction( SIGTERM , &action , NULL ); 
+	
+	os << "Watching " << options.folder << " for new snapshots (Ctrl-C to stop) ... " << std::endl; 
+	
+	char events [ 64 * ( sizeof(struct inotify_event) + NAME_MAX + 1 ) ] 
+		__attribute__ (( aligned( __alignof__( struct inotify_event ) ) )); 
+	struct pollfd watched; 
+	watched.fd = fd; 
+	watched.events = POLLIN; 
+	while( stop_watching == 0 )
+	{
+		// the signal interrupts poll; the timeout covers a signal that 
+		// arrives just before it 
+		if( poll( &watched , 1 , 250 ) <= 0 )
+		{ continue; }
+		ssize_t length = read( fd , events , sizeof(events) ); 
+		if( length < 0 && errno == EINTR )
+		{ continue; }
+		if( length <= 0 )
+		{ break; }
+		
+		for( char* p = events ; p < events + length ; )
+		{
+			struct inotify_event* event = (struct inotify_event*) p; 
+			p += sizeof(struct inotify_event) + event->len; 
+			if( event->len == 0 )
+			{ continue; }
+			int index = snapshot_index( event->name ); 
+			if( index >= 0 )
+			{ render( index ); }
+		}
+	}
+	
+	close( fd ); 
+	signal( SIGINT , SIG_DFL ); 
+	signal( SIGTERM , SIG_DFL ); 
+	os << "Stopped watching " << options.folder << "." << std::endl; 
+	return true; 
+}
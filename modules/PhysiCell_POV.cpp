@@ -227,6 +227,13 @@ void Write_POV_start( std::ostream& os )
 }
 
 void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish )
+{
+	Write_POV_sphere( os, center, radius, pigment, finish, default_POV_options.no_shadow, default_POV_options.no_reflection ); 
+	return; 
+}
+
+void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish , 
+	bool no_shadow, bool no_reflection )
 {
 	os 	<< "sphere" << std::endl << "{" << std::endl 
 		<< " <" << center[0] << "," << center[1] << "," << center[2] << ">, " << radius
@@ -234,9 +241,9 @@ void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double rad
 		<< " pigment {color rgb<" << pigment[0] << "," << pigment[1] << "," << pigment[2] << ">}" << std::endl
 		<< " finish {ambient " << finish[0] << " diffuse " << finish[1] << " specular " << finish[2] << "}" << std::endl;
 		
-		if( default_POV_options.no_shadow )
+		if( no_shadow )
 		{ os << " no_shadow "; }
-		if( default_POV_options.no_reflection )
+		if( no_reflection )
 		{ os << " no_reflection "; }
 	os 	<< "}" << std::endl; 
 	return;
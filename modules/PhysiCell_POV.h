@@ -139,5 +139,8 @@ void Write_POV_start( std::ostream& os );
 // pigment: [r,g,b,f], where they vary from 0 to 1. I suggest f = 0. 
 // finish: [ambient,diffuse,specular]
 void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish );
+// as above, but with explicit shadow/reflection flags (safe to call from several threads)
+void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish , 
+	bool no_shadow, bool no_reflection );
 					
 #endif
@@ -0,0 +1,228 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+// Checks that the incremental manifest (povwriter_manifest.h) marks a frame 
+// stale when any setting that its scene depends on changes, and up to date 
+// again once the setting is put back. Build and run from the repository 
+// root with "make manifest-test" (it loads ./config/povwriter-settings.xml). 
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <functional>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../custom_modules/povwriter.h" 
+#include "../custom_modules/povwriter_manifest.h" 
+
+static const std::string folder = "manifest_test"; 
+static const std::string manifest = folder + "/povwriter.manifest"; 
+static int failures = 0; 
+
+static void check( bool condition , std::string what )
+{
+	std::cout << ( condition ? "ok:     " : "FAILED: " ) << what << std::endl; 
+	if( condition == false )
+	{ failures++; }
+	return; 
+}
+
+static bool is_up_to_date( void )
+{
+	Frame_Manifest loaded; 
+	if( loaded.open( manifest ) == false )
+	{ return false; }
+	bool up_to_date = loaded.is_up_to_date( 0 ); 
+	loaded.close(); 
+	return up_to_date; 
+}
+
+// change a setting: the frame must be stale; put it back: up to date 
+static void check_setting( std::string name , std::function<void(void)> change , std::function<void(void)> restore )
+{
+	change(); 
+	bool stale = is_up_to_date() == false; 
+	restore(); 
+	check( stale && is_up_to_date() , name + " makes the frame stale" ); 
+	return; 
+}
+
+static void check_value( std::string name , double& value , double new_value )
+{
+	double old_value = value; 
+	check_setting( name , [&]() { value = new_value; } , [&]() { value = old_value; } ); 
+	return; 
+}
+
+static void check_flag( std::string name , bool& value )
+{
+	check_setting( name , [&]() { value = !value; } , [&]() { value = !value; } ); 
+	return; 
+}
+
+int main( void )
+{
+	if( load_config_file( "./config/povwriter-settings.xml" ) == false )
+	{ return 1; }
+	setup_POV_camera(); 
+	
+	// a frame 0 with one cell, its scene, and its manifest entry 
+	mkdir( folder.c_str() , 0755 ); 
+	options.folder = folder; 
+	options.filebase = "output"; 
+	options.output = folder + "/pov%08i.pov"; 
+	std::vector< std::vector<double> > cells( 1 , std::vector<double>( 33 , 1.0 ) ); 
+	check( write_matlab( cells , create_filename( 0 ) ) , "write a snapshot" ); 
+	{
+		std::vector< std::vector<cell_real> > MAT( 33 , std::vector<cell_real>( 1 , 1 ) ); 
+		std::ofstream scene( create_output_filename( 0 ) ); 
+		write_frame( scene , MAT ); 
+	}
+	struct stat info; 
+	stat( create_output_filename( 0 ).c_str() , &info ); 
+	unlink( manifest.c_str() ); 
+	frame_manifest.open( manifest ); 
+	frame_manifest.record( 0 , frame_source_hash( 0 ) , info.st_size ); 
+	frame_manifest.close(); 
+	check( is_up_to_date() , "the recorded frame is up to date" ); 
+	
+	// every coefficient of every clipping plane 
+	check( default_POV_options.clipping_planes.size() > 0 , "the config has clipping planes" ); 
+	for( unsigned int k=0 ; k < default_POV_options.clipping_planes.size() ; k++ )
+	{
+		for( int c=0 ; c < 4 ; c++ )
+		{
+			double& value = default_POV_options.clipping_planes[k].coefficients[c]; 
+			check_value( "clipping plane " + std::to_string(k) + " coefficient " + std::to_string(c) , 
+				value , value + 100 ); 
+		}
+	}
+	check_setting( "one more clipping plane" , 
+		[&]() { default_POV_options.clipping_planes.push_back( default_POV_options.clipping_planes[0] ); } , 
+		[&]() { default_POV_options.clipping_planes.pop_back(); } ); 
+	
+	check_value( "nuclear_offset" , options.nuclear_offset , options.nuclear_offset + 50 ); 
+	check_value( "cell_bound" , options.cell_bound , options.cell_bound / 2 ); 
+	check_flag( "no_shadow" , default_POV_options.no_shadow ); 
+	check_flag( "no_reflection" , default_POV_options.no_reflection ); 
+	
+	// every color of every cell type 
+	for( unsigned int k=0 ; k < cell_color_definitions.size() ; k++ )
+	{
+		std::string type = "type " + std::to_string( cell_color_definitions[k].type ) + " "; 
+		Cell_Colorset* sets [3] = { &cell_color_definitions[k].live , &cell_color_definitions[k].apoptotic , 
+			&cell_color_definitions[k].necrotic }; 
+		std::string set_names [3] = { "live" , "apoptotic" , "necrotic" }; 
+		for( int s=0 ; s < 3 ; s++ )
+		{
+			check_value( type + set_names[s] + " cytoplasm" , sets[s]->cyto_pigment[0] , sets[s]->cyto_pigment[0] + 0.5 ); 
+			check_value( type + set_names[s] + " nucleus" , sets[s]->nuclear_pigment[1] , sets[s]->nuclear_pigment[1] + 0.5 ); 
+			check_value( type + set_names[s] + " finish" , sets[s]->finish[2] , sets[s]->finish[2] + 0.5 ); 
+		}
+		check_setting( type + "number" , [&]() { cell_color_definitions[k].type += 100; } , 
+			[&]() { cell_color_definitions[k].type -= 100; } ); 
+	}
+	
+	void (*colors)(Cell_Colorset&,std::vector<std::vector<cell_real>>&,int) = pigment_and_finish_function; 
+	check_setting( "the coloring function" , 
+		[&]() { pigment_and_finish_function = colors == standard_pigment_and_finish_function ? 
+			cancer_immune_pigment_and_finish_function : standard_pigment_and_finish_function; } , 
+		[&]() { pigment_and_finish_function = colors; } ); 
+	
+	// the scene header 
+	check_value( "camera position" , default_POV_options.camera_position[0] , default_POV_options.camera_position[0] + 10 ); 
+	check_value( "light position" , default_POV_options.light_position[2] , default_POV_options.light_position[2] + 10 ); 
+	check_value( "background" , default_POV_options.background[0] , 1 - default_POV_options.background[0] ); 
+	
+	// cameras, tiles, and the render cache 
+	Camera_View view; 
+	view.name = "side"; 
+	view.distance = 1000; 
+	view.theta = 0; 
+	view.phi = 1; 
+	check_setting( "another camera" , [&]() { options.cameras.push_back( view ); } , 
+		[&]() { options.cameras.pop_back(); } ); 
+	check_flag( "tiles" , options.tiles ); 
+	check_flag( "render_cache" , options.render_cache ); 
+	
+	unlink( create_output_filename( 0 ).c_str() ); 
+	unlink( create_filename( 0 ).c_str() ); 
+	unlink( manifest.c_str() ); 
+	rmdir( folder.c_str() ); 
+	
+	if( failures > 0 )
+	{
+		std::cout << failures << " check(s) failed!" << std::endl; 
+		return 1; 
+	}
+	std::cout << "All checks passed." << std::endl; 
+	return 0; 
+}
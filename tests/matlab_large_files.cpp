@@ -0,0 +1,321 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2019, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+// Round trips of MATLAB v4 files larger than 4 GiB through read_matlab() 
+// and write_matlab(), to check the 64-bit sizes and offsets. Build and run 
+// with "make matlab-test" (or "make matlab-test TEST_FOLDER=/some/where"). 
+// 
+// read:  a sparse 16 x (2^25+4096) file (4 GiB + 512 kiB) built from a 
+//        header, ftruncate, and a few columns written past 4 GiB; then 
+//        read_matlab() into single precision (2 GiB of RAM) 
+// write: write_matlab() of a (2^25+4096) x 16 matrix (4 GiB of RAM); 
+//        skipped if there is not that much memory available 
+// 
+// It also checks that headers cut short or with a corrupt name length are 
+// rejected. 
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "../BioFVM/BioFVM_matlab.h" 
+
+using namespace BioFVM; 
+
+static const uint64_t four_GiB = 4ull << 30; 
+static const unsigned int large = (1u << 25) + 4096; 
+static int failures = 0; 
+
+static void check( bool condition , std::string what )
+{
+	std::cout << ( condition ? "ok:     " : "FAILED: " ) << what << std::endl; 
+	if( condition == false )
+	{ failures++; }
+	return; 
+}
+
+// MemAvailable (which counts reclaimable page cache) if known, else free pages 
+static uint64_t available_memory( void )
+{
+	FILE* fp = fopen( "/proc/meminfo" , "r" ); 
+	char line[256]; 
+	unsigned long long kB; 
+	while( fp != NULL && fgets( line , sizeof(line) , fp ) != NULL )
+	{
+		if( sscanf( line , "MemAvailable: %llu kB" , &kB ) == 1 )
+		{
+			fclose( fp ); 
+			return (uint64_t) kB << 10; 
+		}
+	}
+	if( fp != NULL )
+	{ fclose( fp ); }
+	return (uint64_t) sysconf( _SC_AVPHYS_PAGES ) * (uint64_t) sysconf( _SC_PAGESIZE ); 
+}
+
+// write rows doubles (value + i) as column j of an open file 
+static bool write_column( FILE* fp , off_t data_offset , unsigned int rows , uint64_t j , double value )
+{
+	std::vector<double> column( rows ); 
+	for( unsigned int i=0 ; i < rows ; i++ )
+	{ column[i] = value + i; }
+	return seek_matlab_column( fp , data_offset , rows , 0 , j ) 
+		&& fwrite( column.data() , sizeof(double) , rows , fp ) == rows; 
+}
+
+static void test_sparse_read( std::string filename )
+{
+	unsigned int rows = 16; 
+	unsigned int cols = large; 
+	uint64_t data_size = (uint64_t) rows * cols * sizeof(double); 
+	
+	FILE* fp = write_matlab_header( rows , cols , filename , "none" ); 
+	check( fp != NULL , "write_matlab_header of a sparse file" ); 
+	if( fp == NULL )
+	{ return; }
+	off_t data_offset = ftello( fp ); 
+	fflush( fp ); 
+	bool written = ftruncate( fileno( fp ) , data_offset + (off_t) data_size ) == 0; 
+	
+	// the first column, and columns on either side of 4 GiB of data 
+	uint64_t last_below = four_GiB / ( rows * sizeof(double) ) - 1; 
+	written = written && write_column( fp , data_offset , rows , 0 , 1.0 ) 
+		&& write_column( fp , data_offset , rows , last_below , 100.0 ) 
+		&& write_column( fp , data_offset , rows , last_below+1 , 200.0 ) 
+		&& write_column( fp , data_offset , rows , cols-1 , 300.0 ); 
+	fclose( fp ); 
+	check( written , "a sparse file of " + std::to_string( data_offset + data_size ) + " bytes" ); 
+	
+	// the header and seek, past 4 GiB 
+	unsigned int r , c , format; 
+	off_t offset; 
+	fp = read_matlab_header( &r , &c , &format , &offset , NULL , filename ); 
+	check( fp != NULL && r == rows && c == cols && format == 0 && offset == data_offset , 
+		"read_matlab_header: rows, cols, format, and data offset" ); 
+	if( fp != NULL )
+	{
+		double value = 0; 
+		bool found = seek_matlab_column( fp , offset , r , format , cols-1 ) 
+			&& fseeko( fp , 5*sizeof(double) , SEEK_CUR ) == 0 
+			&& fread( &value , sizeof(double) , 1 , fp ) == 1; 
+		check( found && ftello( fp ) > (off_t) four_GiB && value == 305.0 , "seek_matlab_column past 4 GiB" ); 
+		fclose( fp ); 
+	}
+	
+	// the whole file 
+	if( available_memory() < (uint64_t) rows * cols * sizeof(float) * 5/4 )
+	{
+		std::cout << "skipped: read_matlab (needs " << ( (uint64_t) rows * cols * sizeof(float) >> 20 ) 
+			<< " MB of free memory)" << std::endl; 
+	}
+	else
+	{
+		std::vector< std::vector<float> > MAT; 
+		bool read = read_matlab( filename , MAT , (std::string*) NULL ); 
+		check( read && MAT.size() == rows && MAT[0].size() == cols , "read_matlab of the whole file" ); 
+		if( read )
+		{
+			bool values = true; 
+			for( unsigned int i=0 ; i < rows ; i++ )
+			{
+				values = values && MAT[i][0] == 1.0f + i && MAT[i][last_below] == 100.0f + i 
+					&& MAT[i][last_below+1] == 200.0f + i && MAT[i][cols-1] == 300.0f + i 
+					&& MAT[i][1] == 0.0f && MAT[i][cols-2] == 0.0f; 
+			}
+			check( values , "read_matlab: the columns on either side of 4 GiB" ); 
+		}
+	}
+	
+	// a file one entry short of its header is rejected (before allocating) 
+	written = truncate( filename.c_str() , data_offset + (off_t) data_size - sizeof(double) ) == 0; 
+	std::vector< std::vector<double> > MAT; 
+	check( written && read_matlab( filename , MAT , (std::string*) NULL ) == false && MAT.size() == 0 , 
+		"read_matlab of a truncated file fails" ); 
+	
+	unlink( filename.c_str() ); 
+	return; 
+}
+
+// a header of these 32-bit fields, then extra bytes of name 
+static bool write_header( std::string filename , std::vector<unsigned int> fields , unsigned int extra )
+{
+	FILE* fp = fopen( filename.c_str() , "wb" ); 
+	if( fp == NULL )
+	{ return false; }
+	std::vector<char> name( extra , 'x' ); 
+	bool written = fwrite( fields.data() , sizeof(unsigned int) , fields.size() , fp ) == fields.size() 
+		&& fwrite( name.data() , 1 , extra , fp ) == extra; 
+	return fclose( fp ) == 0 && written; 
+}
+
+static void test_corrupt_header( std::string filename )
+{
+	unsigned int r , c , format; 
+	off_t offset; 
+	
+	// type, rows, cols, imag, and name length, cut after each field 
+	std::vector<unsigned int> fields = { 0 , 2 , 3 , 0 , 5 }; 
+	for( unsigned int n=1 ; n < fields.size() ; n++ )
+	{
+		std::vector<unsigned int> short_fields( fields.begin() , fields.begin() + n ); 
+		check( write_header( filename , short_fields , 0 ) 
+			&& read_matlab_header( &r , &c , &format , &offset , NULL , filename ) == NULL , 
+			"a header of " + std::to_string( n ) + " fields is rejected" ); 
+	}
+	
+	// a name longer than the file, or than any real name 
+	check( write_header( filename , { 0 , 2 , 3 , 0 , 5 } , 4 ) 
+		&& read_matlab_header( &r , &c , &format , &offset , NULL , filename ) == NULL , 
+		"a name that runs past the end of the file is rejected" ); 
+	check( write_header( filename , { 0 , 2 , 3 , 0 , 0xfffffff0u } , 16 ) 
+		&& read_matlab_header( &r , &c , &format , &offset , NULL , filename ) == NULL , 
+		"a name length of 4 GB is rejected" ); 
+	
+	std::string name; 
+	FILE* fp = write_header( filename , { 0 , 2 , 3 , 0 , 5 } , 5 ) ? 
+		read_matlab_header( &r , &c , &format , &offset , &name , filename ) : NULL; 
+	check( fp != NULL && r == 2 && c == 3 && offset == 25 && name == "xxxxx" , "a whole header is read" ); 
+	if( fp != NULL )
+	{ fclose( fp ); }
+	
+	unlink( filename.c_str() ); 
+	return; 
+}
+
+static void test_write( std::string filename )
+{
+	unsigned int rows = large; 
+	unsigned int cols = 16; 
+	uint64_t data_size = (uint64_t) rows * cols * sizeof(double); 
+	if( available_memory() < data_size * 9/8 )
+	{
+		std::cout << "skipped: write_matlab (needs " << ( data_size >> 20 ) << " MB of free memory)" << std::endl; 
+		return; 
+	}
+	
+	// write_matlab stores input[j] as column j 
+	bool written; 
+	{
+		std::vector< std::vector<double> > input( cols ); 
+		for( unsigned int j=0 ; j < cols ; j++ )
+		{
+			input[j].assign( rows , 0.0 ); 
+			input[j][0] = j; 
+			input[j][rows-1] = 1000.0 + j; 
+		}
+		written = write_matlab( input , filename ); 
+	}
+	check( written , "write_matlab of " + std::to_string( data_size ) + " bytes of data" ); 
+	
+	unsigned int r , c , format; 
+	off_t offset; 
+	FILE* fp = read_matlab_header( &r , &c , &format , &offset , NULL , filename ); 
+	check( fp != NULL && r == rows && c == cols && format == 0 , "read_matlab_header of the written file" ); 
+	if( fp == NULL )
+	{ return; }
+	fseeko( fp , 0 , SEEK_END ); 
+	check( ftello( fp ) == offset + (off_t) data_size , "file size" ); 
+	
+	bool values = true; 
+	for( unsigned int j=0 ; j < cols ; j++ )
+	{
+		double first = -1; 
+		double last = -1; 
+		values = values && seek_matlab_column( fp , offset , r , format , j ) 
+			&& fread( &first , sizeof(double) , 1 , fp ) == 1 
+			&& fseeko( fp , (off_t) ( rows-2 ) * sizeof(double) , SEEK_CUR ) == 0 
+			&& fread( &last , sizeof(double) , 1 , fp ) == 1 
+			&& first == j && last == 1000.0 + j; 
+	}
+	check( values , "the first and last entry of every column" ); 
+	fclose( fp ); 
+	
+	unlink( filename.c_str() ); 
+	return; 
+}
+
+int main( int argc , char* argv[] )
+{
+	std::string folder = argc > 1 ? argv[1] : "."; 
+	
+	test_corrupt_header( folder + "/matlab_corrupt_header.mat" ); 
+	test_sparse_read( folder + "/matlab_large_sparse.mat" ); 
+	test_write( folder + "/matlab_large_write.mat" ); 
+	
+	if( failures > 0 )
+	{
+		std::cout << failures << " check(s) failed!" << std::endl; 
+		return 1; 
+	}
+	std::cout << "All checks passed." << std::endl; 
+	return 0; 
+}